@@ -0,0 +1,769 @@
+// *****************************************************************************
+// File         [ hexBench.cpp ]
+// Description  [ Timings for the HEX file hot paths, old against new.
+//                Usage: hexBench [megabytes of HEX text, default 4]
+//                       hexBench --suite [largest image in KB, default 512]
+//              ]
+// Author       [ Keith Sabine ]
+// *****************************************************************************
+
+#include "hexCodec.h"
+#include "hexDiff.h"
+#include "hexDigest.h"
+#include "hexFile.h"
+#include "hexFormat.h"
+#include "hexImage.h"
+#include "hexParser.h"
+#include "wireProtocol.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryFile>
+#include <QThread>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+// *****************************************************************************
+// Allocation counting: every operator new in the program goes through here
+// *****************************************************************************
+static std::atomic<size_t>    s_Allocations(0);
+static std::atomic<size_t>    s_AllocatedBytes(0);
+
+void *
+operator new(size_t n)
+{
+    s_Allocations++;
+    s_AllocatedBytes += n;
+    if (void *p = std::malloc(n ? n : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void
+operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void
+operator delete(void *p, size_t) noexcept
+{
+    std::free(p);
+}
+
+// *****************************************************************************
+// Function     [ makeHexText ]
+// Description  [ Synthesise an Intel HEX file of roughly textBytes characters,
+//                16 data bytes to a record, using 04 records above 64k.
+//              ]
+// *****************************************************************************
+static std::string
+makeHexText(size_t textBytes)
+{
+    static const char digits[] = "0123456789ABCDEF";
+    std::mt19937 rng(1234);
+    std::string text;
+    text.reserve(textBytes + 64);
+
+    auto appendRecord = [&](const uint8_t *rec, size_t n) {
+        text.push_back(':');
+        for (size_t i = 0; i < n; ++i) {
+            text.push_back(digits[rec[i] >> 4]);
+            text.push_back(digits[rec[i] & 15]);
+        }
+        text.append("\r\n");
+    };
+
+    uint32_t address = 0;
+    while (text.size() < textBytes) {
+        // Each new 64k starts with an extended linear address record
+        if ((address & 0xffff) == 0 && address != 0) {
+            uint8_t ext[7] = { 2, 0, 0, 4, (uint8_t) (address >> 24), (uint8_t) (address >> 16), 0 };
+            ext[6] = (uint8_t) (~((ext[0] + ext[3] + ext[4] + ext[5]) & 0xff) + 1);
+            appendRecord(ext, sizeof(ext));
+        }
+
+        uint8_t rec[21];
+        rec[0] = 16;
+        rec[1] = (uint8_t) (address >> 8);
+        rec[2] = (uint8_t) address;
+        rec[3] = 0;
+        uint32_t sum = rec[0] + rec[1] + rec[2];
+        for (int32_t i = 0; i < 16; ++i) {
+            rec[4 + i] = (uint8_t) rng();
+            sum += rec[4 + i];
+        }
+        rec[20] = (uint8_t) (~(sum & 0xff) + 1);
+
+        appendRecord(rec, sizeof(rec));
+        address += 16;
+    }
+    text.append(":00000001FF\r\n");
+    return text;
+}
+
+// *****************************************************************************
+// Function     [ legacyReadHex ]
+// Description  [ The original line by line QString parse, kept as a baseline.
+//                It knows nothing of 04 records, but costs the same.
+//              ]
+// *****************************************************************************
+static bool
+legacyReadHex(const QString &fileName, hexImage &image)
+{
+    QFile fi(fileName);
+    if (!fi.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    bool ok = true;
+    QString s;
+    image.clear();
+    while (!fi.atEnd()) {
+        QString line = fi.readLine();
+        line.remove("\n");
+        int32_t index = line.indexOf(QChar(':'));
+        if (index < 0) {
+            return false;
+        }
+        s = line.sliced(++index, 2);
+        uint8_t byteCount = s.toInt(&ok, 16);
+        index += 2;
+        s = line.sliced(index, 2);
+        uint8_t hi = s.toInt(&ok, 16);
+        index += 2;
+        s = line.sliced(index, 2);
+        uint8_t lo = s.toInt(&ok, 16);
+        index += 2;
+        s = line.sliced(index, 2);
+        int8_t recType = s.toInt(&ok, 16);
+        if (recType == 1) {
+            return true;
+        }
+        index += 2;
+        uint8_t data[256];
+        for (int32_t i = 0; i < byteCount; ++i) {
+            s = line.sliced(index, 2);
+            data[i] = (uint8_t) s.toInt(&ok, 16);
+            index += 2;
+        }
+        s = line.sliced(index, 2);
+        s.toInt(&ok, 16);
+        image.write((uint16_t) ((hi << 8) + lo), data, byteCount);
+    }
+    return true;
+}
+
+// *****************************************************************************
+// Function     [ mappedReadHex ]
+// Description  [ The new path: map the file and decode it in place ]
+// *****************************************************************************
+static bool
+mappedReadHex(const QString &fileName, hexImage &image)
+{
+    QFile fi(fileName);
+    if (!fi.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    const qint64 length = fi.size();
+    uchar *map = fi.map(0, length);
+    if (map == nullptr) {
+        return false;
+    }
+    image.clear();
+    bool ok = hexParse(reinterpret_cast<const char *>(map), (size_t) length, image, nullptr);
+    fi.unmap(map);
+    return ok;
+}
+
+// *****************************************************************************
+// Function     [ bestOf ]
+// Description  [ Best wall time in seconds of a few runs ]
+// *****************************************************************************
+static double
+bestOf(int32_t runs, const std::function<void()> &fn)
+{
+    double best = 1e30;
+    for (int32_t i = 0; i < runs; ++i) {
+        QElapsedTimer timer;
+        timer.start();
+        fn();
+        double t = timer.nsecsElapsed() * 1e-9;
+        if (t < best) {
+            best = t;
+        }
+    }
+    return best;
+}
+
+// *****************************************************************************
+// Function     [ benchReadHex ]
+// Description  [ ]
+// *****************************************************************************
+static void
+benchReadHex(double megabytes)
+{
+    std::string text = makeHexText((size_t) (megabytes * 1024 * 1024));
+
+    QTemporaryFile file;
+    if (!file.open()) {
+        std::printf("Can't create a temporary file\n");
+        return;
+    }
+    file.write(text.data(), (qint64) text.size());
+    file.flush();
+    const QString name = file.fileName();
+
+    hexImage image;
+    double mb = text.size() / (1024.0 * 1024.0);
+    double tOld = bestOf(3, [&] { legacyReadHex(name, image); });
+    double tNew = bestOf(3, [&] { mappedReadHex(name, image); });
+
+    std::printf("readHex %.1f MB of text\n", mb);
+    std::printf("  QString per line : %8.2f ms  %8.1f MB/s\n", tOld * 1e3, mb / tOld);
+    std::printf("  mapped in place  : %8.2f ms  %8.1f MB/s\n", tNew * 1e3, mb / tNew);
+    std::printf("  speedup          : %8.1fx\n", tOld / tNew);
+}
+
+// *****************************************************************************
+// Function     [ benchParseThreads ]
+// Description  [ hexParse of the same text on 1, 2, 4... threads, up to the
+//                core count, to show how the parallel decode scales.
+//              ]
+// *****************************************************************************
+static void
+benchParseThreads(double megabytes)
+{
+    std::string text = makeHexText((size_t) (megabytes * 1024 * 1024));
+    double mb = text.size() / (1024.0 * 1024.0);
+    const uint32_t cores = (uint32_t) std::max(1, QThread::idealThreadCount());
+
+    std::printf("hexParse %.1f MB of text, %u cores\n", mb, cores);
+    double tOne = 0.0;
+    for (uint32_t threads = 1; ; threads *= 2) {
+        if (threads > cores) {
+            threads = cores;
+        }
+        double t = bestOf(3, [&] {
+            hexImage image;
+            hexParse(text.data(), text.size(), image, nullptr, threads);
+        });
+        if (threads == 1) {
+            tOne = t;
+        }
+        std::printf("  %2u threads       : %8.2f ms  %8.1f MB/s  (%.1fx)\n",
+                    threads, t * 1e3, mb / t, tOne / t);
+        if (threads == cores) {
+            break;
+        }
+    }
+}
+
+// *****************************************************************************
+// Function     [ benchStreamParse ]
+// Description  [ hexStreamParser fed in slices of various sizes, against
+//                hexParse on the whole buffer.
+//              ]
+// *****************************************************************************
+static void
+benchStreamParse(double megabytes)
+{
+    std::string text = makeHexText((size_t) (megabytes * 1024 * 1024));
+    double mb = text.size() / (1024.0 * 1024.0);
+
+    double tWhole = bestOf(3, [&] {
+        hexImage image;
+        hexParse(text.data(), text.size(), image, nullptr);
+    });
+    std::printf("hexStreamParser %.1f MB of text\n", mb);
+    std::printf("  whole buffer     : %8.2f ms  %8.1f MB/s\n", tWhole * 1e3, mb / tWhole);
+
+    for (size_t slice : { (size_t) 64, (size_t) 4096, (size_t) 65536 }) {
+        double t = bestOf(3, [&] {
+            hexImage image;
+            hexStreamParser parser(image);
+            for (size_t i = 0; i < text.size(); i += slice) {
+                parser.feed(text.data() + i, std::min(slice, text.size() - i));
+            }
+            parser.finish();
+        });
+        std::printf("  %5zu byte slices : %8.2f ms  %8.1f MB/s\n", slice, t * 1e3, mb / t);
+    }
+}
+
+// *****************************************************************************
+// Function     [ legacyWriteHex ]
+// Description  [ The original writer: a QString per record built with arg()
+//                and toUpper(), and a write per line.
+//              ]
+// *****************************************************************************
+static void
+legacyWriteHex(const QString &fileName, const hexImage &image)
+{
+    QFile fi(fileName);
+    if (!fi.open(QIODevice::WriteOnly)) {
+        return;
+    }
+    const hexSpanView spans = image.spans();
+    for (auto iter = spans.begin(); iter != spans.end(); ++iter) {
+        for (size_t offset = 0; offset < iter->size; offset += 16) {
+            int32_t byteCount = (int32_t) std::min<size_t>(16, iter->size - offset);
+            uint16_t address = (uint16_t) (iter->address + offset);
+            QString line, s;
+            line.append(QChar(':'));
+            s = QString("%1").arg(byteCount, 2, 16, QChar('0'));
+            line.append(s.toUpper());
+            s = QString("%1").arg(address, 4, 16, QChar('0'));
+            line.append(s.toUpper());
+            s = QString("%1").arg(0, 2, 16, QChar('0'));
+            line.append(s.toUpper());
+            uint32_t checkSum = byteCount + (address >> 8) + (address & 0xff);
+            for (int32_t i = 0; i < byteCount; ++i) {
+                uint8_t d = iter->data[offset + i];
+                checkSum += d;
+                s = QString("%1").arg((uint) d, 2, 16, QChar('0'));
+                line.append(s.toUpper());
+            }
+            s = QString("%1\n").arg((uint) (uint8_t) (~(checkSum & 0xff) + 1), 2, 16, QChar('0'));
+            line.append(s.toUpper());
+            fi.write(line.toLatin1());
+        }
+    }
+    fi.write(QString(":00000001FF\n").toLatin1());
+}
+
+// *****************************************************************************
+// Function     [ benchWriteHex ]
+// Description  [ Saving an image of the given size, the old way and with
+//                the Intel HEX saver at each record length.
+//              ]
+// *****************************************************************************
+static void
+benchWriteHex(double megabytes)
+{
+    std::mt19937 rng(7);
+    std::vector<uint8_t> bytes((size_t) (megabytes * 1024 * 1024 / 2));
+    for (size_t i = 0; i < bytes.size(); ++i) {
+        bytes[i] = (uint8_t) rng();
+    }
+    hexImage image;
+    image.write(0, bytes.data(), bytes.size());
+
+    QTemporaryFile file;
+    if (!file.open()) {
+        std::printf("Can't create a temporary file\n");
+        return;
+    }
+    const QString name = file.fileName();
+    file.close();
+
+    double mb = bytes.size() / (1024.0 * 1024.0);
+    double tOld = bestOf(3, [&] { legacyWriteHex(name, image); });
+    std::printf("writeHex %.1f MB image\n", mb);
+    std::printf("  QString per line : %8.2f ms  %8.1f MB/s  %10lld bytes\n",
+                tOld * 1e3, mb / tOld, (long long) QFileInfo(name).size());
+
+    const hexFormat *intel = hexFormatFor(hexFormat::IntelHex);
+    for (uint32_t length : { 16u, 32u, 64u, 255u }) {
+        hexSaveOptions options;
+        options.recordLength = length;
+        size_t size = 0;
+        double t = bestOf(3, [&] {
+            std::string out;
+            intel->save(image, out, options);
+            QFile fi(name);
+            if (fi.open(QIODevice::WriteOnly)) {
+                fi.write(out.data(), (qint64) out.size());
+            }
+            size = out.size();
+        });
+        std::printf("  %3u byte records : %8.2f ms  %8.1f MB/s  %10zu bytes  (%.0fx)\n",
+                    length, t * 1e3, mb / t, size, tOld / t);
+    }
+}
+
+// *****************************************************************************
+// Function     [ benchDigests ]
+// Description  [ CRC32 and SHA-256 of an image, then the cached CRC after
+//                a one byte edit, which only reads the block that changed.
+//              ]
+// *****************************************************************************
+static void
+benchDigests(double megabytes)
+{
+    std::mt19937 rng(5);
+    std::vector<uint8_t> bytes((size_t) (megabytes * 1024 * 1024 / 2));
+    for (size_t i = 0; i < bytes.size(); ++i) {
+        bytes[i] = (uint8_t) rng();
+    }
+    hexFile file;
+    file.image().write(0, bytes.data(), bytes.size());
+
+    uint32_t sink = 0;
+    double tCrc = bestOf(3, [&] { sink += crc32(bytes.data(), bytes.size()); });
+    double tSha = bestOf(3, [&] {
+        sha256 h;
+        uint8_t digest[sha256::digestSize];
+        h.update(bytes.data(), bytes.size());
+        h.finish(digest);
+        sink += digest[0];
+    });
+    double tEdit = bestOf(3, [&] {
+        file.image().write((uint32_t) (rng() % bytes.size()), (uint8_t) rng());
+        sink += file.imageCrc32();
+    });
+
+    double mb = bytes.size() / (1024.0 * 1024.0);
+    std::printf("digests %.1f MB image\n", mb);
+    std::printf("  CRC32            : %8.2f ms  %8.1f MB/s\n", tCrc * 1e3, mb / tCrc);
+    std::printf("  SHA-256          : %8.2f ms  %8.1f MB/s\n", tSha * 1e3, mb / tSha);
+    std::printf("  CRC32 after edit : %8.3f ms  (%.0fx)\n", tEdit * 1e3, tCrc / tEdit);
+    if (sink == 0) {
+        std::printf("\n");
+    }
+}
+
+// *****************************************************************************
+// Function     [ benchSpanViews ]
+// Description  [ What a programming thread costs just to walk the image,
+//                over the 100 passes a 2708 takes: the original copies of
+//                every chunk and its data, a vector of spans per pass, and
+//                the hexSpanView iterators.
+//              ]
+// *****************************************************************************
+static void
+benchSpanViews(double megabytes)
+{
+    // Data with a hole every 4k, so there are plenty of runs
+    std::mt19937 rng(3);
+    hexImage image;
+    const size_t total = (size_t) (megabytes * 1024 * 1024 / 8);
+    std::vector<uint8_t> block(4095);
+    for (uint32_t address = 0; address < total; address += 4096) {
+        for (size_t i = 0; i < block.size(); ++i) {
+            block[i] = (uint8_t) rng();
+        }
+        image.write(address, block.data(), block.size());
+    }
+
+    // The original hexDataChunk layout: an address and a vector each
+    struct chunk
+    {
+        uint32_t              address;
+        std::vector<uint8_t>  data;
+    };
+    std::vector<chunk> chunks;
+    for (const hexSpan &span : image.spans()) {
+        for (size_t offset = 0; offset < span.size; offset += 16) {
+            size_t n = std::min<size_t>(16, span.size - offset);
+            chunks.push_back(chunk { span.address + (uint32_t) offset,
+                                     std::vector<uint8_t>(span.data + offset, span.data + offset + n) });
+        }
+    }
+
+    const int32_t passes = 100;
+    size_t sink = 0;
+    auto measure = [&](const char *name, const std::function<void()> &pass) {
+        size_t allocations = s_Allocations;
+        size_t bytes = s_AllocatedBytes;
+        QElapsedTimer timer;
+        timer.start();
+        for (int32_t i = 0; i < passes; ++i) {
+            pass();
+        }
+        double t = timer.nsecsElapsed() * 1e-9;
+        std::printf("  %-17s: %8.2f ms  %10zu allocations  %12zu bytes\n", name, t * 1e3,
+                    (size_t) s_Allocations - allocations, (size_t) s_AllocatedBytes - bytes);
+    };
+
+    std::printf("image walk, %zu bytes in %zu runs, %d passes\n", image.size(), image.spans().count(), passes);
+    measure("chunk copies", [&] {
+        std::vector<chunk> hData = chunks;
+        for (auto iter = hData.begin(); iter != hData.end(); ++iter) {
+            chunk c = *iter;
+            std::vector<uint8_t> data = c.data;
+            for (size_t i = 0; i < data.size(); ++i) {
+                sink += data[i];
+            }
+        }
+    });
+    measure("vector of spans", [&] {
+        std::vector<hexSpan> spans(image.spans().begin(), image.spans().end());
+        for (auto iter = spans.begin(); iter != spans.end(); ++iter) {
+            for (size_t i = 0; i < iter->size; ++i) {
+                sink += iter->data[i];
+            }
+        }
+    });
+    measure("hexSpanView", [&] {
+        for (const hexSpan &span : image.spans()) {
+            for (size_t i = 0; i < span.size; ++i) {
+                sink += span.data[i];
+            }
+        }
+    });
+    if (sink == 0) {
+        std::printf("\n");
+    }
+}
+
+// *****************************************************************************
+// Function     [ benchHexCodec ]
+// Description  [ Hex pair encode and decode, the per byte QString calls the
+//                threads and response handlers used against hexCodec.
+//              ]
+// *****************************************************************************
+static void
+benchHexCodec(double megabytes)
+{
+    const size_t n = (size_t) (megabytes * 1024 * 1024 / 2);
+    std::mt19937 rng(99);
+    std::vector<uint8_t> bytes(n);
+    for (size_t i = 0; i < n; ++i) {
+        bytes[i] = (uint8_t) rng();
+    }
+    std::vector<char> text(2 * n);
+    std::vector<uint8_t> back(n);
+    size_t sink = 0;
+
+    double tOldEnc = bestOf(3, [&] {
+        for (size_t i = 0; i < n; ++i) {
+            const short d = bytes[i];
+            QByteArray c = QString("%1").arg(d, 2, 16, QChar('0')).toUtf8();
+            sink += c.size();
+        }
+    });
+    double tNewEnc = bestOf(3, [&] { hexEncode(bytes.data(), n, text.data()); });
+
+    const QString qtext = QString::fromLatin1(text.data(), (qsizetype) text.size());
+    double tOldDec = bestOf(3, [&] {
+        bool ok = true;
+        for (size_t i = 0; i < n; ++i) {
+            back[i] = (uint8_t) qtext.mid((qsizetype) (2 * i), 2).toInt(&ok, 16);
+        }
+    });
+    double tNewDec = bestOf(3, [&] { sink += hexDecode(text.data(), n, back.data()); });
+
+    double mb = n / (1024.0 * 1024.0);
+    std::printf("hex codec %.1f MB of bytes, using %s\n", mb, hexCodecName());
+    std::printf("  encode QString   : %8.2f ms  %8.1f MB/s\n", tOldEnc * 1e3, mb / tOldEnc);
+    std::printf("  encode hexCodec  : %8.2f ms  %8.1f MB/s  (%.0fx)\n", tNewEnc * 1e3, mb / tNewEnc, tOldEnc / tNewEnc);
+    std::printf("  decode QString   : %8.2f ms  %8.1f MB/s\n", tOldDec * 1e3, mb / tOldDec);
+    std::printf("  decode hexCodec  : %8.2f ms  %8.1f MB/s  (%.0fx)\n", tNewDec * 1e3, mb / tNewDec, tOldDec / tNewDec);
+    if (sink == 0) {
+        std::printf("\n");
+    }
+}
+
+// *****************************************************************************
+// Function     [ benchDiff ]
+// Description  [ Verify's compare of a readback against the image: a byte
+//                at a time as the original did, then hexDiff, for a clean
+//                device and one with a bad bit every 4k.
+//              ]
+// *****************************************************************************
+static void
+benchDiff(double megabytes)
+{
+    const size_t n = (size_t) (megabytes * 1024 * 1024 / 2);
+    std::mt19937 rng(11);
+    std::vector<uint8_t> expected(n);
+    for (size_t i = 0; i < n; ++i) {
+        expected[i] = (uint8_t) rng();
+    }
+    std::vector<uint8_t> clean = expected;
+    std::vector<uint8_t> faulty = expected;
+    for (size_t i = 0; i < n; i += 4096) {
+        faulty[i + rng() % std::min<size_t>(4096, n - i)] ^= (uint8_t) (1 << (rng() % 8));
+    }
+
+    size_t sink = 0;
+    auto byteLoop = [&](const std::vector<uint8_t> &actual) {
+        for (size_t i = 0; i < n; ++i) {
+            if (expected[i] != actual[i]) {
+                sink++;
+            }
+        }
+    };
+    auto diff = [&](const std::vector<uint8_t> &actual) {
+        hexDiffReport report;
+        hexDiff(expected.data(), actual.data(), n, 0, report);
+        sink += report.bytes;
+    };
+    double tOldClean = bestOf(5, [&] { byteLoop(clean); });
+    double tNewClean = bestOf(5, [&] { diff(clean); });
+    double tOldFaulty = bestOf(5, [&] { byteLoop(faulty); });
+    double tNewFaulty = bestOf(5, [&] { diff(faulty); });
+
+    double mb = n / (1024.0 * 1024.0);
+    std::printf("diff %.1f MB image\n", mb);
+    std::printf("  clean per byte   : %8.2f ms  %8.1f MB/s\n", tOldClean * 1e3, mb / tOldClean);
+    std::printf("  clean hexDiff    : %8.2f ms  %8.1f MB/s  (%.0fx)\n", tNewClean * 1e3, mb / tNewClean, tOldClean / tNewClean);
+    std::printf("  faulty per byte  : %8.2f ms  %8.1f MB/s\n", tOldFaulty * 1e3, mb / tOldFaulty);
+    std::printf("  faulty hexDiff   : %8.2f ms  %8.1f MB/s  (%.0fx)\n", tNewFaulty * 1e3, mb / tNewFaulty, tOldFaulty / tNewFaulty);
+    if (sink == 0) {
+        std::printf("\n");
+    }
+}
+
+// *****************************************************************************
+// Class        [ suiteResult ]
+// Description  [ One path timed at one size ]
+// *****************************************************************************
+struct suiteResult
+{
+    double                    nsPerByte;
+    double                    allocationsPerOp;
+};
+
+// *****************************************************************************
+// Function     [ measureOp ]
+// Description  [ Time op on n bytes, repeating it for at least 20ms a batch
+//                and keeping the best of three batches, and count the
+//                allocations it makes each time.
+//              ]
+// *****************************************************************************
+static suiteResult
+measureOp(size_t n, const std::function<void()> &op)
+{
+    QElapsedTimer timer;
+    timer.start();
+    op();
+    double once = std::max(timer.nsecsElapsed() * 1e-9, 1e-8);
+    const size_t reps = std::max<size_t>(1, (size_t) (0.02 / once));
+
+    suiteResult result = { 1e30, 0.0 };
+    for (int32_t batch = 0; batch < 3; ++batch) {
+        size_t allocations = s_Allocations;
+        timer.restart();
+        for (size_t i = 0; i < reps; ++i) {
+            op();
+        }
+        double t = timer.nsecsElapsed() * 1e-9;
+        result.nsPerByte = std::min(result.nsPerByte, t * 1e9 / ((double) reps * n));
+        result.allocationsPerOp = (double) ((size_t) s_Allocations - allocations) / reps;
+    }
+    return result;
+}
+
+// *****************************************************************************
+// Function     [ benchSuite ]
+// Description  [ Each hot path on images of 2k up to maxKB, in ns per image
+//                byte and allocations per operation, for tracking changes
+//                from one build to the next.
+//              ]
+// *****************************************************************************
+static void
+benchSuite(size_t maxKB)
+{
+    QTemporaryFile in;
+    QTemporaryFile out;
+    if (!in.open() || !out.open()) {
+        std::printf("Can't create a temporary file\n");
+        return;
+    }
+    const QString inName = in.fileName();
+    const QString outName = out.fileName();
+
+    const char *names[] = { "readHex", "writeHex", "size", "wire encode", "dump parse" };
+    const size_t paths = sizeof(names) / sizeof(names[0]);
+    std::printf("suite, ns/byte (allocations/op)\n");
+    std::printf("  %6s", "KB");
+    for (size_t p = 0; p < paths; ++p) {
+        std::printf("  %18s", names[p]);
+    }
+    std::printf("\n");
+
+    std::mt19937 rng(2);
+    size_t sink = 0;
+    for (size_t kb = 2; kb <= maxKB; kb *= 2) {
+        const size_t n = kb * 1024;
+        std::vector<uint8_t> bytes(n);
+        for (size_t i = 0; i < n; ++i) {
+            bytes[i] = (uint8_t) rng();
+        }
+        hexFile file;
+        file.image().write(0, bytes.data(), n);
+        file.writeHex(inName);
+
+        // What the ASCII programmer sends back for a read of this image
+        std::string text;
+        wireDumpText(bytes.data(), n, text);
+        std::vector<char> wire(2 * n);
+        std::vector<uint8_t> device(n);
+
+        suiteResult r[paths];
+        r[0] = measureOp(n, [&] {
+            hexFile f;
+            f.readHex(inName);
+            sink += f.size();
+        });
+        r[1] = measureOp(n, [&] { file.writeHex(outName); });
+        r[2] = measureOp(n, [&] { sink += file.size(); });
+        r[3] = measureOp(n, [&] {
+            // Two characters per byte, as the burn engine sends them
+            char *w = wire.data();
+            for (const hexSpan &span : file.spans()) {
+                for (size_t i = 0; i < span.size; ++i) {
+                    hexEncodeByte(span.data[i], w);
+                    w += 2;
+                }
+            }
+            sink += wire[0];
+        });
+        r[4] = measureOp(n, [&] {
+            // As the programmer's read checks and decodes it
+            wireDumpParse(text.data(), text.size(), device);
+            sink += device[0];
+        });
+
+        std::printf("  %6zu", kb);
+        for (size_t p = 0; p < paths; ++p) {
+            std::printf("  %9.3f (%6.1f)", r[p].nsPerByte, r[p].allocationsPerOp);
+        }
+        std::printf("\n");
+    }
+    if (sink == 0) {
+        std::printf("\n");
+    }
+}
+
+// *****************************************************************************
+// Function     [ main ]
+// Description  [ ]
+// *****************************************************************************
+int
+main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    if (argc > 1 && std::string(argv[1]) == "--suite") {
+        benchSuite(argc > 2 ? (size_t) std::atoi(argv[2]) : 512);
+        return 0;
+    }
+
+    double megabytes = 4.0;
+    if (argc > 1) {
+        megabytes = std::atof(argv[1]);
+    }
+
+    benchReadHex(megabytes);
+    benchParseThreads(megabytes);
+    benchStreamParse(megabytes);
+    benchWriteHex(megabytes);
+    benchHexCodec(megabytes);
+    benchDigests(megabytes);
+    benchSpanViews(megabytes);
+    benchDiff(megabytes);
+    return 0;
+}
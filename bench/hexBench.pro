@@ -0,0 +1,41 @@
+TEMPLATE = app
+TARGET = hexBench
+DESTDIR = .
+
+QT += core
+QT -= gui
+
+CONFIG += console thread sdk_no_version_check c++17
+CONFIG -= app_bundle
+
+CONFIG(release, debug|release) {
+    OBJECTS_DIR = release
+    DESTDIR = release
+}
+CONFIG(debug, debug|release) {
+    OBJECTS_DIR = debug
+    DESTDIR = debug
+}
+
+INCLUDEPATH += ..
+
+HEADERS += \
+    ../hexCodec.h \
+    ../hexDiff.h \
+    ../hexDigest.h \
+    ../hexFile.h \
+    ../hexFormat.h \
+    ../hexImage.h \
+    ../hexParser.h \
+    ../wireProtocol.h
+
+SOURCES += \
+    hexBench.cpp \
+    ../hexCodec.cpp \
+    ../hexDiff.cpp \
+    ../hexDigest.cpp \
+    ../hexFile.cpp \
+    ../hexFormat.cpp \
+    ../hexImage.cpp \
+    ../hexParser.cpp \
+    ../wireProtocol.cpp
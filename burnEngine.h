@@ -0,0 +1,258 @@
+#ifndef BURNENGINE_H
+#define BURNENGINE_H
+
+// *****************************************************************************
+// File         [ burnEngine.h ]
+// Description  [ Writing a device, once for them all. There was a thread
+//                class per device, each a copy of the others but for its
+//                byte count, pulse width and passes, so every fix to the
+//                burn had to be made six times. Here the device is the
+//                template argument, and its traits constants, so each
+//                device still gets a hot loop of its own. Like
+//                wireSendBlocks, the port need only have the write(),
+//                flush(), waitForReadyRead() and readAll() of a
+//                QSerialPort, so the simulator drives the same engine.
+//              ]
+// Author       [ Keith Sabine ]
+// *****************************************************************************
+
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+#include "deviceTraits.h"
+#include "hexImage.h"
+#include "pulsePacer.h"
+#include "realTime.h"
+#include "wireBlocks.h"
+#include "wirePipeline.h"
+#include "wireReply.h"
+
+// *****************************************************************************
+// Class        [ burnSettings ]
+// Description  [ How the programmer takes the write, as init found it, and
+//                how to run it. Timeouts are in mS.
+//              ]
+// *****************************************************************************
+struct burnSettings
+{
+    bool                      binary = false;   // binary framing
+    bool                      framed = false;   // the OK or CRC as a Status frame
+    int32_t                   window = 0;       // blocks in flight, or not block writes if 0
+    bool                      realTime = false; // real time priority, pinned and locked, if allowed
+    int32_t                   waitTimeout = 10000;
+};
+
+// *****************************************************************************
+// Class        [ burnReport ]
+// Description  [ How a burn went, and how it kept time ]
+// *****************************************************************************
+struct burnReport
+{
+    enum Status
+    {
+        Done,
+        Failed,
+        TimedOut
+    };
+
+    Status                    status = Failed;
+    std::string               error;
+    size_t                    bytes = 0;
+    std::vector<std::string>  pacing;
+};
+
+// *****************************************************************************
+// Class        [ burnEngine ]
+// Description  [ One burn of Device, over a port already open and set up,
+//                in the caller's thread. A device written several times
+//                over stops at the first pass that fails.
+//              ]
+// *****************************************************************************
+template <class Device>
+class burnEngine
+{
+public:
+    typedef std::function<void(int32_t)> progressFunc;
+
+    explicit                  burnEngine(const burnSettings &s) : m_Settings(s) {}
+
+    template <class Port>
+    burnReport                burn(Port &port, const hexSpanView &spans, const progressFunc &progress);
+
+private:
+    template <class Port>
+    burnReport                blocks(Port &port, const hexSpanView &spans, const progressFunc &progress);
+    template <class Port>
+    burnReport                paced(Port &port, const hexSpanView &spans, const progressFunc &progress);
+    template <class Port>
+    bool                      status(Port &port, size_t count, burnReport &report);
+    static burnReport       & ended(burnReport &report, size_t count);
+
+    burnSettings              m_Settings;
+};
+
+// *****************************************************************************
+// Function     [ burn ]
+// Description  [ ]
+// *****************************************************************************
+template <class Device>
+template <class Port>
+burnReport
+burnEngine<Device>::burn(Port &port, const hexSpanView &spans, const progressFunc &progress)
+{
+    return m_Settings.window > 0 ? blocks(port, spans, progress) : paced(port, spans, progress);
+}
+
+// *****************************************************************************
+// Function     [ blocks ]
+// Description  [ With block writes the programmer paces the pulses itself
+//                and acks each block once programmed, so only blocks lost
+//                on the way go again.
+//              ]
+// *****************************************************************************
+template <class Device>
+template <class Port>
+burnReport
+burnEngine<Device>::blocks(Port &port, const hexSpanView &spans, const progressFunc &progress)
+{
+    burnReport report;
+    for (int32_t pass = 0; pass < Device::passes; ++pass) {
+        port.write(Device::blockCmd, std::strlen(Device::blockCmd));
+        wireBlockSender sender(spans, m_Settings.window);
+        const bool sent = wireSendBlocks(port, sender, m_Settings.waitTimeout, [&](int32_t pct) {
+            if (progress) {
+                progress((pass * 100 + pct) / Device::passes);
+            }
+        });
+        if (!sent) {
+            report.error = "Block write failed, " + std::to_string(sender.acknowledged()) +
+                           " of " + std::to_string(sender.size()) + " bytes acknowledged";
+            return report;
+        }
+        report.bytes = sender.size();
+    }
+    report.status = burnReport::Done;
+    return report;
+}
+
+// *****************************************************************************
+// Function     [ paced ]
+// Description  [ A producer thread builds the stream once for all the
+//                passes, the cmd, the size, the data as bytes, raw or using
+//                pairs of chars, and in binary the CRC, queues it up a
+//                slice at a time and keeps the progress. This one is left
+//                as the I/O stage, only pacing and writing.
+//              ]
+// *****************************************************************************
+template <class Device>
+template <class Port>
+burnReport
+burnEngine<Device>::paced(Port &port, const hexSpanView &spans, const progressFunc &progress)
+{
+    burnReport report;
+    wirePipeline pipe(Device::writeCmd, spans, m_Settings.binary, Device::passes);
+    pipe.start(progress);
+
+    // The bytes go out at the pulse width, against deadlines so that the
+    // time writing them doesn't add up. Its record of them is allocated
+    // now, not byte by byte.
+    pulsePacer pacer((std::chrono::microseconds(Device::pulseMicros)));
+    pacer.reserve(pipe.count() * (size_t) Device::passes);
+
+    // Optionally in real time, for steadier deadlines on a busy PC. Not
+    // until the stream is built, as the producer may share the core.
+    const wireStream &stream = pipe.stream();
+    realTimeScope rt(m_Settings.realTime);
+    rt.prefault(stream.head(), stream.size());
+
+    for (int32_t pass = 0; pass < Device::passes; ++pass) {
+        // Send the cmd and the size, max 64k. In the frame header, or 2 hex chars.
+        wireSlice slice;
+        if (!pipe.next(slice)) {
+            return ended(report, 0);
+        }
+        pipe.send(port, slice);
+        pacer.start();
+
+        // Send the data as bytes, raw or using pairs of chars.
+        size_t count = 0;
+        for (size_t i = 0; i < pipe.count(); ++i) {
+            // Taken first, so that it is in hand at the deadline
+            if (!pipe.next(slice)) {
+                return ended(report, count);
+            }
+            pacer.wait();
+            pipe.send(port, slice);
+            count++;
+        }
+
+        // The CRC, in binary
+        if (!pipe.next(slice)) {
+            return ended(report, count);
+        }
+        pipe.send(port, slice);
+
+        if (!status(port, count, report)) {
+            return report;
+        }
+    }
+
+    report.pacing.push_back(rt.text() + ": " + pulseStatsText(pacer.stats()));
+    report.pacing.push_back(wirePipelineText(pipe.stats()));
+    report.status = burnReport::Done;
+    return report;
+}
+
+// *****************************************************************************
+// Function     [ status ]
+// Description  [ Read response from the PIC, should be 'OK' ('CRC' if a
+//                binary frame was garbled), framed if init said so. That is
+//                the end of it, no waiting for the line to go quiet, and a
+//                framed reply that fails its own CRC is said to, not taken
+//                for a failed write.
+//              ]
+// *****************************************************************************
+template <class Device>
+template <class Port>
+bool
+burnEngine<Device>::status(Port &port, size_t count, burnReport &report)
+{
+    decltype(port.readAll()) response;
+    wireReply reply = m_Settings.framed ? wireReply::status() : wireReply::token({ "OK", "CRC" });
+    report.bytes = count;
+    if (!wireReadReply(port, reply, m_Settings.waitTimeout, 10, response)) {
+        report.status = burnReport::TimedOut;
+        report.error = "Write cmd response timeout";
+        return false;
+    }
+    if (m_Settings.framed && !reply.ok()) {
+        report.error = "Bad reply frame after writing " + std::to_string(count) + " bytes";
+        return false;
+    }
+    const std::string text = m_Settings.framed ? reply.text()
+                                               : std::string(response.data(), (size_t) response.size());
+    if (text != "OK") {
+        report.error = "Failed to write " + std::to_string(count) + " bytes";
+        return false;
+    }
+    return true;
+}
+
+// *****************************************************************************
+// Function     [ ended ]
+// Description  [ The stream ran out before the pass did, which it only
+//                should if the producer was stopped
+//              ]
+// *****************************************************************************
+template <class Device>
+burnReport &
+burnEngine<Device>::ended(burnReport &report, size_t count)
+{
+    report.bytes = count;
+    report.error = "Write stream ended after " + std::to_string(count) + " bytes";
+    return report;
+}
+
+#endif /* BURNENGINE_H */
@@ -0,0 +1,81 @@
+// *****************************************************************************
+// File         [ deviceTraits.cpp ]
+// Description  [ The device traits as run time values ]
+// Author       [ Keith Sabine ]
+// *****************************************************************************
+
+#include "deviceTraits.h"
+
+// *****************************************************************************
+// Function     [ infoOf ]
+// Description  [ ]
+// *****************************************************************************
+template <class Device>
+static deviceInfo
+infoOf()
+{
+    deviceInfo info;
+    info.name = Device::name;
+    info.type = Device::type;
+    info.capacity = Device::capacity;
+    info.pulseMicros = Device::pulseMicros;
+    info.passes = Device::passes;
+    info.erased = Device::erased;
+    return info;
+}
+
+// *****************************************************************************
+// Function     [ infoAll ]
+// Description  [ ]
+// *****************************************************************************
+template <class... Devices>
+static std::vector<deviceInfo>
+infoAll(deviceList<Devices...>)
+{
+    return std::vector<deviceInfo>{ infoOf<Devices>()... };
+}
+
+// *****************************************************************************
+// Function     [ deviceAll ]
+// Description  [ ]
+// *****************************************************************************
+std::vector<deviceInfo>
+deviceAll()
+{
+    return infoAll(knownDevices());
+}
+
+// *****************************************************************************
+// Function     [ deviceFind ]
+// Description  [ ]
+// *****************************************************************************
+bool
+deviceFind(const std::string &name, deviceInfo &info)
+{
+    for (const deviceInfo &device : deviceAll()) {
+        if (name == device.name) {
+            info = device;
+            return true;
+        }
+    }
+    return false;
+}
+
+// *****************************************************************************
+// Function     [ deviceFindType ]
+// Description  [ ]
+// *****************************************************************************
+bool
+deviceFindType(char type, deviceInfo &info)
+{
+    if (type == 0) {
+        return false;
+    }
+    for (const deviceInfo &device : deviceAll()) {
+        if (type == device.type) {
+            info = device;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,187 @@
+#ifndef DEVICETRAITS_H
+#define DEVICETRAITS_H
+
+// *****************************************************************************
+// File         [ deviceTraits.h ]
+// Description  [ What sets one device apart from another, known at compile
+//                time so that burnEngine is built around each: how much it
+//                holds, its programming pulse, how many times over it is
+//                written, what it erases to, and its cmds. A new device is
+//                one traits struct here, given its place in knownDevices.
+//              ]
+// Author       [ Keith Sabine ]
+// *****************************************************************************
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Cmds for PIC
+#define CMD_DONE "$0"
+#define CMD_READ "$1"
+#define CMD_WRTE "$2"
+#define CMD_CHEK "$3"
+#define CMD_IDEN "$4"
+#define CMD_TYPE "$5"
+#define CMD_PROT "$6"
+#define CMD_BLKW "$7"
+#define CMD_RSET "$9"
+#define CMD_INIT "U"
+
+// Device type codes
+#define DEV_2716  0
+#define DEV_2732  1
+#define DEV_2532  2
+#define DEV_2708  3
+#define DEV_T2716 4
+#define DEV_8755  5
+#define DEV_8748  6
+
+// *****************************************************************************
+// Class        [ deviceTraits ]
+// Description  [ What most devices share. Each device's traits derive from
+//                it and give a name, a type, 0 if the PIC has no $5 code
+//                for it, a capacity in bytes and a pulse width in uS.
+//              ]
+// *****************************************************************************
+struct deviceTraits
+{
+    static constexpr int32_t      passes = 1;
+    static constexpr uint8_t      erased = 0xff;
+    static constexpr const char * writeCmd = CMD_WRTE;
+    static constexpr const char * blockCmd = CMD_BLKW;
+};
+
+struct device2708 : deviceTraits
+{
+    static constexpr const char * name = "2708";
+    static constexpr char         type = '0' + DEV_2708;
+    static constexpr size_t       capacity = 1024;
+    static constexpr int64_t      pulseMicros = 1000;
+    static constexpr int32_t      passes = 100;
+};
+
+struct deviceT2716 : deviceTraits
+{
+    static constexpr const char * name = "TMS2716";
+    static constexpr char         type = '0' + DEV_T2716;
+    static constexpr size_t       capacity = 2048;
+    static constexpr int64_t      pulseMicros = 1000;
+    static constexpr int32_t      passes = 100;
+};
+
+struct device2716 : deviceTraits
+{
+    static constexpr const char * name = "2716";
+    static constexpr char         type = '0' + DEV_2716;
+    static constexpr size_t       capacity = 2048;
+    static constexpr int64_t      pulseMicros = 50000;
+};
+
+struct device2532 : deviceTraits
+{
+    static constexpr const char * name = "2532";
+    static constexpr char         type = '0' + DEV_2532;
+    static constexpr size_t       capacity = 4096;
+    static constexpr int64_t      pulseMicros = 50000;
+};
+
+struct device2732 : deviceTraits
+{
+    static constexpr const char * name = "2732";
+    static constexpr char         type = '0' + DEV_2732;
+    static constexpr size_t       capacity = 4096;
+    static constexpr int64_t      pulseMicros = 50000;
+};
+
+struct device8755 : deviceTraits
+{
+    static constexpr const char * name = "8755";
+    static constexpr char         type = '0' + DEV_8755;
+    static constexpr size_t       capacity = 2048;
+    static constexpr int64_t      pulseMicros = 50000;
+};
+
+struct device8748 : deviceTraits
+{
+    static constexpr const char * name = "8748";
+    static constexpr char         type = '0' + DEV_8748;
+    static constexpr size_t       capacity = 1024;
+    static constexpr int64_t      pulseMicros = 50000;
+    static constexpr uint8_t      erased = 0x00;
+};
+
+struct device8749 : deviceTraits
+{
+    static constexpr const char * name = "8749";
+    static constexpr char         type = 0;
+    static constexpr size_t       capacity = 2048;
+    static constexpr int64_t      pulseMicros = 50000;
+    static constexpr uint8_t      erased = 0x00;
+};
+
+template <class... Devices>
+struct deviceList
+{
+};
+
+// In the order they are offered
+typedef deviceList<device2708, deviceT2716, device2716, device2532,
+                   device2732, device8755, device8748, device8749> knownDevices;
+
+// *****************************************************************************
+// Function     [ deviceVisit ]
+// Description  [ Calls visit(Device()) with the traits of the device named,
+//                and returns false if there is none.
+//              ]
+// *****************************************************************************
+template <class Visitor>
+bool
+deviceVisit(const std::string &, Visitor &, deviceList<>)
+{
+    return false;
+}
+
+template <class Visitor, class Device, class... Rest>
+bool
+deviceVisit(const std::string &name, Visitor &visit, deviceList<Device, Rest...>)
+{
+    if (name == Device::name) {
+        visit(Device());
+        return true;
+    }
+    return deviceVisit(name, visit, deviceList<Rest...>());
+}
+
+template <class Visitor>
+bool
+deviceVisit(const std::string &name, Visitor &visit)
+{
+    return deviceVisit(name, visit, knownDevices());
+}
+
+// *****************************************************************************
+// Class        [ deviceInfo ]
+// Description  [ A device's traits as values, for when which device isn't
+//                known until run time
+//              ]
+// *****************************************************************************
+struct deviceInfo
+{
+    const char              * name = nullptr;
+    char                      type = 0;
+    size_t                    capacity = 0;
+    int64_t                   pulseMicros = 0;
+    int32_t                   passes = 0;
+    uint8_t                   erased = 0xff;
+};
+
+// The device named, or false
+bool                          deviceFind(const std::string &name, deviceInfo &info);
+// The device with this $5 code, or false
+bool                          deviceFindType(char type, deviceInfo &info);
+// All of them, in knownDevices order
+std::vector<deviceInfo>       deviceAll();
+
+#endif /* DEVICETRAITS_H */
@@ -36,29 +36,50 @@ INCLUDEPATH += . \
 HEADERS += \
     hexFile.h \
     guiMainWindow.h \
-    initThread.h \
     qLedWidget.h \
-    readThread.h \
-    E8755Thread.h \
-    E2708Thread.h \
-    E2716Thread.h \
-    TMS2716Thread.h \
-    E2532Thread.h \
-	E2732Thread.h
+    hexBits.h \
+    hexImage.h \
+    hexParser.h \
+    hexCodec.h \
+    hexFormat.h \
+    hexDigest.h \
+    hexDiff.h \
+    hexMerge.h \
+    wireProtocol.h \
+    wireBlocks.h \
+    pulsePacer.h \
+    realTime.h \
+    wireStream.h \
+    spscRing.h \
+    wirePipeline.h \
+    serialHub.h \
+    wireReply.h \
+    programmer.h \
+    deviceTraits.h \
+    burnEngine.h
 
 SOURCES += \
     hexFile.cpp \
     guiMainWindow.cpp \
-    initThread.cpp \
     main.cpp \
     qLedWidget.cpp \
-    readThread.cpp \
-    E8755Thread.cpp \
-    E2708Thread.cpp \
-    E2716Thread.cpp \
-    TMS2716Thread.cpp \
-    E2532Thread.cpp \
-    E2732Thread.cpp
+    hexImage.cpp \
+    hexParser.cpp \
+    hexCodec.cpp \
+    hexFormat.cpp \
+    hexDigest.cpp \
+    hexDiff.cpp \
+    hexMerge.cpp \
+    wireProtocol.cpp \
+    wireBlocks.cpp \
+    pulsePacer.cpp \
+    realTime.cpp \
+    wireStream.cpp \
+    wirePipeline.cpp \
+    serialHub.cpp \
+    wireReply.cpp \
+    programmer.cpp \
+    deviceTraits.cpp
 
 FORMS += \
     guiMainWindow.ui
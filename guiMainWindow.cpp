@@ -5,19 +5,20 @@
 // *****************************************************************************
 
 #include "guiMainWindow.h"
-#include "E8755Thread.h"
-#include "E2708Thread.h"
-#include "E2716Thread.h"
-#include "E2532Thread.h"
-#include "E2732Thread.h"
-#include "TMS2716Thread.h"
+#include "hexCodec.h"
+#include "hexDiff.h"
+#include "hexDigest.h"
+#include "hexMerge.h"
+#include "wireProtocol.h"
 
 #include <QtWidgets/QFileDialog>
+#include <QtWidgets/QInputDialog>
+#include <QFileInfo>
+#include <QFutureWatcher>
 #include <QtWidgets/QMessageBox>
 #include <QtSerialPort/QSerialPortInfo>
 
-#include <chrono>
-#include <thread>
+#include <cstdio>
 
 // *****************************************************************************
 // Function     [ constructor ]
@@ -38,6 +39,8 @@ guiMainWindow::guiMainWindow(QWidget *parent)
     // Set connections
     QObject::connect(ui.actionOpen_HEX_file, SIGNAL(triggered()),                this, SLOT(openHexFile()));
     QObject::connect(ui.actionSave_HEX_file, SIGNAL(triggered()),                this, SLOT(saveHexFile()));
+    QObject::connect(ui.actionMerge_files,   SIGNAL(triggered()),                this, SLOT(mergeFiles()));
+    QObject::connect(ui.actionCompare_files, SIGNAL(triggered()),                this, SLOT(compareFiles()));
     QObject::connect(ui.actionQuit,          SIGNAL(triggered()),                this, SLOT(quit()));
     QObject::connect(ui.initButton,          SIGNAL(pressed()),                  this, SLOT(init()));
     QObject::connect(ui.readButton,          SIGNAL(pressed()),                  this, SLOT(read()));
@@ -67,6 +70,11 @@ guiMainWindow::guiMainWindow(QWidget *parent)
     ui.baudRate->addItem("4800");
     ui.baudRate->addItem("2400");
 
+    // Device types, one for each set of traits
+    for (const deviceInfo &device : deviceAll()) {
+        ui.deviceType->addItem(device.name);
+    }
+
     this->setStatusBar(&m_statusBar);
 
     QLabel* label = new QLabel("Status");
@@ -86,23 +94,136 @@ guiMainWindow::guiMainWindow(QWidget *parent)
     m_progressBar->hide();
 
     m_HexFile = new hexFile;
-    m_HexFile->setMainWindow(this);
     m_initOK = false;
+    m_busy = 0;
+
+    m_serialHub = new serialHub;
+    m_serialHub->moveToThread(&m_ioThread);
+    // Its ports and timers are the I/O thread's, so it goes there too
+    QObject::connect(&m_ioThread, &QThread::finished, m_serialHub, &QObject::deleteLater);
+    m_programmer = new programmer(m_serialHub);
+    m_ioThread.start();
 
     // Until we have init the baud rate, disable the buttons
-    ui.checkButton->setEnabled(false);
-    ui.readButton->setEnabled(false);
-    ui.writeButton->setEnabled(false);
-    ui.verifyButton->setEnabled(false);
-    ui.resetButton->setEnabled(false);
+    updateActions();
+}
+
+// *****************************************************************************
+// Function     [ fileFilter ]
+// Description  [ File dialog filter for all the formats we can read or
+//                write, optionally led by an entry matching any of them.
+//              ]
+// *****************************************************************************
+static QString
+fileFilter(bool allSupported)
+{
+    QStringList filters;
+    QStringList patterns;
+    const std::vector<const hexFormat *> &formats = hexFormats();
+    for (auto iter = formats.begin(); iter != formats.end(); ++iter) {
+        filters << QString("%1 (%2)").arg((*iter)->name()).arg((*iter)->patterns());
+        patterns << (*iter)->patterns();
+    }
+    if (allSupported) {
+        filters.prepend(QString("All supported (%1)").arg(patterns.join(' ')));
+        filters << "All files (*)";
+    }
+    return filters.join(";;");
+}
+
+// *****************************************************************************
+// Function     [ diffText ]
+// Description  [ A line per differing range, with the bits flipped each way,
+//                then the totals.
+//              ]
+// *****************************************************************************
+static QString
+diffText(const hexDiffReport &report)
+{
+    // Like the diagnostics, a bad device could give thousands of these
+    const size_t maxShown = 1000;
+    QString text;
+    for (size_t i = 0; i < report.ranges.size() && i < maxShown; ++i) {
+        const hexDiffRange &r = report.ranges[i];
+        text += QString("%1-%2: %3 byte(s), %4 bit(s) 1->0, %5 bit(s) 0->1\n")
+                .arg(r.address, 4, 16, QChar('0'))
+                .arg(r.address + r.size - 1, 4, 16, QChar('0'))
+                .arg(r.size).arg(r.cleared).arg(r.set);
+    }
+    if (report.ranges.size() > maxShown) {
+        text += QString("... and %1 more\n").arg(report.ranges.size() - maxShown);
+    }
+    text += QString("%1 of %2 bytes differ in %3 range(s): %4 bit(s) 1->0, %5 bit(s) 0->1")
+            .arg(report.bytes).arg(report.compared).arg(report.ranges.size())
+            .arg(report.cleared).arg(report.set);
+    return text;
+}
+
+// *****************************************************************************
+// Function     [ whenDone ]
+// Description  [ Hands an operation's result to func, in the GUI thread,
+//                once it is finished. Returns the watcher, for progress.
+//                Until then the programming and file actions are off, so
+//                the same burn can't be queued twice, or the image changed
+//                while a write or verify of it is waiting.
+//              ]
+// *****************************************************************************
+template <class Result, class Func>
+QFutureWatcher<Result> *
+guiMainWindow::whenDone(const QFuture<Result> &future, Func func)
+{
+    m_busy++;
+    updateActions();
+
+    QFutureWatcher<Result> *watcher = new QFutureWatcher<Result>(this);
+    QObject::connect(watcher, &QFutureWatcher<Result>::finished, this, [this, watcher, func]() {
+        m_busy--;
+        if (!watcher->isCanceled()) {
+            func(watcher->result());
+        }
+        updateActions();
+        watcher->deleteLater();
+    });
+    watcher->setFuture(future);
+    return watcher;
+}
+
+// *****************************************************************************
+// Function     [ updateActions ]
+// Description  [ Init until it is done, then the rest, but none of them
+//                while an operation is queued or under way. Nor opening,
+//                merging or saving files, which change the image.
+//              ]
+// *****************************************************************************
+void
+guiMainWindow::updateActions()
+{
+    const bool idle = m_busy == 0;
+    ui.initButton->setEnabled(idle && !m_initOK);
+    ui.checkButton->setEnabled(idle && m_initOK);
+    ui.readButton->setEnabled(idle && m_initOK);
+    ui.writeButton->setEnabled(idle && m_initOK);
+    ui.verifyButton->setEnabled(idle && m_initOK);
+    ui.resetButton->setEnabled(idle && m_initOK);
+
+    ui.loadHexFile->setEnabled(idle);
+    ui.saveHexFile->setEnabled(idle);
+    ui.actionOpen_HEX_file->setEnabled(idle);
+    ui.actionSave_HEX_file->setEnabled(idle);
+    ui.actionMerge_files->setEnabled(idle);
 }
 
 // *****************************************************************************
 // Function     [ destructor ]
-// Description  [ ]
+// Description  [ The serialHub is deleted in its own thread, as that
+//                finishes
+//              ]
 // *****************************************************************************
 guiMainWindow::~guiMainWindow()
 {
+    m_ioThread.quit();
+    m_ioThread.wait();
+    delete m_programmer;
     delete m_HexFile;
 }
 
@@ -113,27 +234,152 @@ guiMainWindow::~guiMainWindow()
 void
 guiMainWindow::openHexFile()
 {
-    QString fileName = QFileDialog::getOpenFileName(this, "Open HEX File...", ".", "*.hex");
-    m_HexFile->readHex(fileName);
+    QString fileName = QFileDialog::getOpenFileName(this, "Open HEX File...", ".", fileFilter(true));
+    if (fileName.isEmpty()) {
+        return;
+    }
 
-    // Display it in the textEdit widget
-    clearText();
-    std::vector<hexDataChunk> data = m_HexFile->hexData();
-    for (auto iter = data.begin(); iter != data.end(); ++iter) {
+    if (readFile(fileName, *m_HexFile)) {
+        showImage();
+        showDigests();
+    }
+    else if (!m_HexFile->diagnostics().empty()) {
+        // Don't keep a partial image around to be written
+        m_HexFile->image().clear();
+    }
+}
 
-        hexDataChunk chunk = *iter;
-        QString line;
+// *****************************************************************************
+// Function     [ readFile ]
+// Description  [ Read a file of any supported format into file, recognising
+//                the format from the start of the file and asking where a
+//                binary file goes. Returns the format read, or nullptr if
+//                there was a problem, reported here, or the user cancelled.
+//              ]
+// *****************************************************************************
+const hexFormat *
+guiMainWindow::readFile(const QString &fileName, hexFile &file)
+{
+    const hexFormat *format = hexFile::sniff(fileName);
+    uint32_t baseAddress = 0;
+    if (format != nullptr && format->kind() == hexFormat::Binary) {
+        // A binary file doesn't say where it goes, so ask
+        bool ok = false;
+        QString base = QInputDialog::getText(this, "Load binary file",
+                                             QString("Base address of %1 (hex):").arg(QFileInfo(fileName).fileName()),
+                                             QLineEdit::Normal, "0", &ok);
+        if (!ok) {
+            return nullptr;
+        }
+        baseAddress = base.trimmed().remove("0x", Qt::CaseInsensitive).toUInt(&ok, 16);
+        if (!ok) {
+            QMessageBox::warning(this, "Not a valid address", QString("Invalid base address %1").arg(base));
+            return nullptr;
+        }
+    }
 
-        // Write the address
-        line.append(QString("%1:").arg(chunk.address(), 4, 16, QChar('0')));
+    if (format != nullptr && file.read(fileName, format, baseAddress)) {
+        return format;
+    }
+    if (file.diagnostics().empty()) {
+        clearText();
+        appendText(QString("Can't open %1").arg(fileName));
+    }
+    else {
+        showDiagnostics(file, fileName);
+    }
+    return nullptr;
+}
 
-        // Write the the data
-        for (int32_t i = 0; i < chunk.byteCount(); ++i) {
-            QString s = QString(" %1").arg(chunk.data().at(i), 2, 16, QChar('0'));
-            line.append(s);
+// *****************************************************************************
+// Function     [ showImage ]
+// Description  [ Display the hex image on the textEdit, 16 bytes to a line.
+//                The text is built up first and handed over in one go.
+//              ]
+// *****************************************************************************
+void
+guiMainWindow::showImage()
+{
+    showImage(m_HexFile->image());
+}
+
+void
+guiMainWindow::showImage(const hexImage &image)
+{
+    const hexSpanView spans = image.spans();
+
+    // Each line is 'aaaa:' then ' xx' per byte and a newline
+    QByteArray text;
+    text.reserve((qsizetype) ((image.size() / 16 + 2 * spans.count()) * 58));
+
+    for (auto iter = spans.begin(); iter != spans.end(); ++iter) {
+        const hexSpan &span = *iter;
+        size_t i = 0;
+        while (i < span.size) {
+            // Write the address
+            char address[16];
+            int32_t n = std::snprintf(address, sizeof(address), "%04x:", span.address + (uint32_t) i);
+            if (!text.isEmpty()) {
+                text.append('\n');
+            }
+            text.append(address, n);
+
+            // Write the the data, up to the next 16 byte boundary
+            do {
+                char pair[3] = { ' ' };
+                hexEncodeByte(span.data[i], pair + 1);
+                text.append(pair, 3);
+                ++i;
+            } while (i < span.size && ((span.address + i) & 0xf) != 0);
         }
-        appendText(line);
     }
+
+    clearText();
+    appendText(QString::fromLatin1(text));
+}
+
+// *****************************************************************************
+// Function     [ showDigests ]
+// Description  [ Put the image's CRC32 and SHA-256 on the status bar ]
+// *****************************************************************************
+void
+guiMainWindow::showDigests()
+{
+    uint8_t sha[sha256::digestSize];
+    char shaText[2 * sha256::digestSize];
+    m_HexFile->imageSha256(sha);
+    hexEncode(sha, sizeof(sha), shaText);
+    statusBar()->showMessage(QString("%1 bytes, CRC32 %2, SHA-256 %3")
+                             .arg(m_HexFile->size())
+                             .arg(m_HexFile->imageCrc32(), 8, 16, QChar('0'))
+                             .arg(QString::fromLatin1(shaText, sizeof(shaText))));
+}
+
+// *****************************************************************************
+// Function     [ showDiagnostics ]
+// Description  [ List the problems found reading a hex file, in one update ]
+// *****************************************************************************
+void
+guiMainWindow::showDiagnostics(const hexFile &file, const QString &fileName)
+{
+    const std::vector<hexDiagnostic> &diagnostics = file.diagnostics();
+    const QString name = QFileInfo(fileName).fileName();
+
+    // A binary file could produce thousands of these, so cap the list
+    const size_t maxShown = 1000;
+    QString text;
+    for (size_t i = 0; i < diagnostics.size() && i < maxShown; ++i) {
+        const hexDiagnostic &d = diagnostics[i];
+        text += QString("%1:%2:%3: %4\n").arg(name).arg(d.line).arg(d.column).arg(hexDiagnosticText(d.kind));
+    }
+    if (diagnostics.size() > maxShown) {
+        text += QString("... and %1 more\n").arg(diagnostics.size() - maxShown);
+    }
+
+    clearText();
+    appendText(text);
+    QMessageBox::warning(this, "Not a valid HEX file",
+                         QString("%1 has %2 error(s) and was not loaded").arg(name).arg(diagnostics.size()));
 }
 
 // *****************************************************************************
@@ -143,66 +389,203 @@ guiMainWindow::openHexFile()
 void
 guiMainWindow::saveHexFile()
 {
-    QString fileName = QFileDialog::getSaveFileName(this, "Save HEX File As...", ".", "*.hex");
-    if (false == fileName.endsWith(".hex")) {
-        fileName += ".hex";
+    QString selected;
+    QString fileName = QFileDialog::getSaveFileName(this, "Save HEX File As...", ".", fileFilter(false), &selected);
+    if (fileName.isEmpty()) {
+        return;
     }
 
-    // Clear any existing hex file
-    m_HexFile->clear();
+    // The format follows the suffix, else the chosen filter, else Intel HEX
+    const hexFormat *format = hexFormatForSuffix(QFileInfo(fileName).suffix().toLatin1().constData());
+    if (format == nullptr) {
+        format = hexFormatFor(hexFormat::IntelHex);
+        const std::vector<const hexFormat *> &formats = hexFormats();
+        for (auto iter = formats.begin(); iter != formats.end(); ++iter) {
+            if (selected.startsWith((*iter)->name())) {
+                format = *iter;
+            }
+        }
+        // Add the first of its suffixes, e.g. ".hex"
+        fileName += QString(format->patterns()).section(' ', 0, 0).remove('*');
+    }
+
+    // Read the textEdit into an image of its own, so that the loaded one is
+    // only replaced once it has all parsed. Only the 'aaaa: xx xx ..' lines
+    // are the image; any messages or reports among them are passed over.
+    hexImage image(m_HexFile->image().fill());
+    image.setStartAddress(m_HexFile->image().startAddress());
 
-    // Read the textEdit and fill hexfile
     QString text = ui.textEdit->toPlainText();
     QStringList lines = text.split("\n", Qt::SkipEmptyParts);
 
-    uint16_t address=0;
-    const int8_t blocksize = 16;
-    hexDataChunk chunk;
-    bool ok=false;
-
     // foreach line
     for (auto line_iter = lines.begin(); line_iter != lines.end(); ++line_iter) {
         QString line = *line_iter;
-        std::vector<uint8_t> data;
-        uint32_t checksum=0;
 
-        // split lines by spaces
+        // split lines by spaces. The first item is the address followed by ':'
         QStringList textlist = line.split(" ", Qt::SkipEmptyParts);
-        for (auto token_iter = textlist.begin(); token_iter != textlist.end(); ++token_iter) {
-
-            QString addr = *token_iter;
-            // The first item is the address followed by ':'
-            if (addr.contains(QChar(':'))) {
-                addr.remove(':');
-                address = addr.toUShort(&ok, 16);
-                chunk.setByteCount(blocksize);
-                checksum += blocksize;
-                chunk.setAddress(address);
-                checksum += address & 0xff;
-                checksum += (address >> 8) & 0xff;
-                chunk.setRecordType(0);
-                checksum += 0;
-                token_iter++;
-            }
+        if (textlist.isEmpty() || !textlist.first().endsWith(QChar(':'))) {
+            continue;
+        }
+        bool ok = false;
+        uint32_t address = textlist.first().chopped(1).toUInt(&ok, 16);
+        if (!ok) {
+            continue;
+        }
 
+        for (auto token_iter = textlist.begin() + 1; token_iter != textlist.end(); ++token_iter) {
             QString item = *token_iter;
             uint8_t d = (uint8_t) item.toUShort(&ok, 16);
-            data.push_back(d);
-            checksum += d;
             if (!ok) {
                 QString message = QString("Invalid byte %1").arg(item);
                 QMessageBox::warning(nullptr, "Not a valid hex value", message);
                 return;
             }
+            image.write(address++, d);
+        }
+    }
+
+    m_HexFile->clear();
+    m_HexFile->image() = image;
+
+    hexSaveOptions options = m_HexFile->saveOptions();
+    options.recordLength = ui.recordLength->currentText().toUInt();
+    m_HexFile->setSaveOptions(options);
+    if (!m_HexFile->write(fileName, format)) {
+        QMessageBox::warning(this, "Save failed", QString("Can't write %1").arg(fileName));
+    }
+    else {
+        showDigests();
+    }
+}
+
+// *****************************************************************************
+// Function     [ compareFiles ]
+// Description  [ Compare two files, of any format we read, and list where
+//                the second differs from the first.
+//              ]
+// *****************************************************************************
+void
+guiMainWindow::compareFiles()
+{
+    QString expectedName = QFileDialog::getOpenFileName(this, "Compare File...", ".", fileFilter(true));
+    if (expectedName.isEmpty()) {
+        return;
+    }
+    QString actualName = QFileDialog::getOpenFileName(this, "With File...", ".", fileFilter(true));
+    if (actualName.isEmpty()) {
+        return;
+    }
+
+    hexFile expected;
+    hexFile actual;
+    if (!readFile(expectedName, expected) || !readFile(actualName, actual)) {
+        return;
+    }
+
+    const hexDiffReport report = hexDiff(expected.image(), actual.image());
+    clearText();
+    appendText(QString("Comparing %1 with %2").arg(QFileInfo(expectedName).fileName())
+                                              .arg(QFileInfo(actualName).fileName()));
+    appendText(diffText(report));
+    if (report.identical()) {
+        statusBar()->showMessage(QString("Files are identical, %1 bytes.").arg(report.compared));
+    }
+    else {
+        statusBar()->showMessage(QString("Files differ in %1 bytes.").arg(report.bytes));
+    }
+}
+
+// *****************************************************************************
+// Function     [ mergeFiles ]
+// Description  [ Load several files, each moved by an optional offset, into
+//                the one image to write. Gaps are filled with the device's
+//                erased value; overlaps are listed, and conflicting ones
+//                stop the merge.
+//              ]
+// *****************************************************************************
+void
+guiMainWindow::mergeFiles()
+{
+    QStringList fileNames = QFileDialog::getOpenFileNames(this, "Merge HEX Files...", ".", fileFilter(true));
+    if (fileNames.isEmpty()) {
+        return;
+    }
+
+    std::vector<hexFile> files(fileNames.size());
+    std::vector<hexMergeInput> inputs;
+    for (qsizetype i = 0; i < fileNames.size(); ++i) {
+        const hexFormat *format = readFile(fileNames[i], files[i]);
+        if (format == nullptr) {
+            return;
+        }
+        int64_t offset = 0;
+        if (format->kind() != hexFormat::Binary) {
+            // A binary file has just been given its address
+            bool ok = false;
+            QString text = QInputDialog::getText(this, "Merge HEX files",
+                                                 QString("Offset of %1 (hex, may be negative):").arg(QFileInfo(fileNames[i]).fileName()),
+                                                 QLineEdit::Normal, "0", &ok);
+            if (!ok) {
+                return;
+            }
+            text = text.trimmed();
+            bool negative = text.startsWith('-');
+            QString digits = text;
+            offset = digits.remove('-').remove("0x", Qt::CaseInsensitive).toUInt(&ok, 16);
+            if (!ok) {
+                QMessageBox::warning(this, "Not a valid offset", QString("Invalid offset %1").arg(text));
+                return;
+            }
+            offset = negative ? -offset : offset;
+        }
+        inputs.push_back(hexMergeInput { &files[i].image(), offset });
+    }
+
+    // Gaps take the erased value of the device selected
+    hexMergeOptions options;
+    deviceInfo device;
+    if (deviceFind(ui.deviceType->currentText().toStdString(), device)) {
+        options.fill = device.erased;
+    }
+
+    m_HexFile->clear();
+    std::vector<hexMergeIssue> issues;
+    bool ok = hexMerge(inputs, m_HexFile->image(), &issues, options);
+
+    QString text;
+    for (auto iter = issues.begin(); iter != issues.end(); ++iter) {
+        const QString first = QFileInfo(fileNames[iter->first]).fileName();
+        if (iter->kind == hexMergeIssue::AddressRange) {
+            text += QString("%1-%2: %3 in %4\n")
+                    .arg(iter->address, 4, 16, QChar('0'))
+                    .arg(iter->address + iter->size - 1, 4, 16, QChar('0'))
+                    .arg(hexMergeIssueText(iter->kind)).arg(first);
+        }
+        else {
+            text += QString("%1-%2: %3 in %4 and %5\n")
+                    .arg(iter->address, 4, 16, QChar('0'))
+                    .arg(iter->address + iter->size - 1, 4, 16, QChar('0'))
+                    .arg(hexMergeIssueText(iter->kind)).arg(first)
+                    .arg(QFileInfo(fileNames[iter->second]).fileName());
         }
-        chunk.setData(data);
-        uint8_t lsb = ~(checksum & 0xff)+1;
-        chunk.setCheckSum(lsb);
-        address += blocksize;
-        m_HexFile->addChunk(chunk);
     }
 
-    m_HexFile->writeHex(fileName);
+    if (ok) {
+        showImage();
+        if (!text.isEmpty()) {
+            appendText(text);
+        }
+        showDigests();
+    }
+    else {
+        // Don't keep a partial image around to be written
+        m_HexFile->image().clear();
+        clearText();
+        appendText(text);
+        QMessageBox::warning(this, "Files not merged",
+                             QString("%1 files could not be merged").arg(fileNames.size()));
+    }
 }
 
 // *****************************************************************************
@@ -219,41 +602,65 @@ guiMainWindow::getFlowControl()
 }
 
 // *****************************************************************************
-// Function     [ reset ]
-// Description  [ Reset the programmer ]
+// Function     [ settings ]
+// Description  [ The link and the device, as set in the controls ]
 // *****************************************************************************
-void
-guiMainWindow::reset()
+programmerSettings
+guiMainWindow::settings()
 {
-    QString portName = ui.serialPort->currentText();
-    int32_t baudRate = ui.baudRate->currentText().toInt();
-    int32_t flowControl = getFlowControl();
-
-    QSerialPort serial;
-
-    serial.setPortName(portName);
-    serial.setBaudRate(baudRate);
-    serial.setFlowControl((QSerialPort::FlowControl)flowControl);
+    programmerSettings s;
+    s.portName = ui.serialPort->currentText();
+    s.baudRate = ui.baudRate->currentText().toInt();
+    s.flowControl = getFlowControl();
+    s.devType = ui.deviceType->currentText();
+    s.timeout = ui.timeOut->value() * 1000;
+    s.window = ui.blockWindow->value();
+    s.realTime = ui.realTime->isChecked();
+    return s;
+}
 
-    if (!serial.open(QIODevice::ReadWrite)) {
-        clearText();
-        appendText(QString("Can't open %1, error code %2").arg(portName).arg(serial.error()));
-        return;
+// *****************************************************************************
+// Function     [ reportFailure ]
+// Description  [ Says why an operation wasn't Done, if it wasn't, and
+//                returns whether so
+//              ]
+// *****************************************************************************
+bool
+guiMainWindow::reportFailure(const programmerResult &r)
+{
+    switch (r.status) {
+    case programmerResult::Done:
+        return false;
+    case programmerResult::TimedOut:
+        serialTimeout(r.error);
+        break;
+    default:
+        serialError(r.error);
+        break;
     }
+    return true;
+}
 
+// *****************************************************************************
+// Function     [ reset ]
+// Description  [ Reset the programmer, on the session's open port. It says
+//                nothing back, and init goes after it.
+//              ]
+// *****************************************************************************
+void
+guiMainWindow::reset()
+{
     // Send the PIC a reset cmd
-    serial.write(CMD_RSET);
-    serial.flush();
-    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    whenDone(m_programmer->reset(settings()), [this](const programmerResult &r) {
+        if (!r.ok()) {
+            clearText();
+            appendText(r.error);
+        }
+    });
     m_initOK = false;
 
     // Until we have init the baud rate, disable the buttons
-    ui.checkButton->setEnabled(false);
-    ui.readButton->setEnabled(false);
-    ui.writeButton->setEnabled(false);
-    ui.verifyButton->setEnabled(false);
-    ui.resetButton->setEnabled(false);
-    ui.initButton->setEnabled(true);
+    updateActions();
 
     clearText();
     statusBar()->showMessage("Ready");
@@ -263,20 +670,13 @@ guiMainWindow::reset()
 // Function     [ init ]
 // Description  [ Send a init command to the PIC via the serial port
 //                The init cmd is 'U' which sets the PIC baud rate.
-//                The PIC will respond with:
-//                - a signal initResponse, data = baud rate
-//                - a signal via typeResponse = device type
+//                The PIC will respond with the baud rate, then to the
+//                protocol and device type cmds, all in one initResult.
 //              ]
 // *****************************************************************************
 void
 guiMainWindow::init()
 {
-    QString portName = ui.serialPort->currentText();
-    int32_t timeout = ui.timeOut->value() * 1000;
-    int32_t baudRate = ui.baudRate->currentText().toInt();
-    int32_t flowControl = getFlowControl();
-    QString devType = ui.deviceType->currentText();
-
     if (m_initOK) {
         QMessageBox::warning(this, "Initialisation", "Serial link already set up!", QMessageBox::Ok);
         return;
@@ -287,72 +687,60 @@ guiMainWindow::init()
         qApp->processEvents();
     }
 
-    initThread init_thread;
-    QObject::connect(&init_thread, SIGNAL(error(const QString&)), this, SLOT(serialError(const QString&)));
-    QObject::connect(&init_thread, SIGNAL(timeout(const QString&)), this, SLOT(serialTimeout(const QString&)));
-    QObject::connect(&init_thread, SIGNAL(response(const QString&)), this, SLOT(initResponse(const QString&)));
-    QObject::connect(&init_thread, SIGNAL(type(const QString&)), this, SLOT(typeResponse(const QString&)));
-    init_thread.transaction(portName,
-                            CMD_INIT,
-                            devType,
-                            timeout,
-                            baudRate,
-                            flowControl);
+    whenDone(m_programmer->init(settings()), [this](const initResult &r) {
+        initResponse(r);
+    });
 }
 
 // *****************************************************************************
 // Function     [ initResponse ]
-// Description  [ The response string should be the baud rate info ]
+// Description  [ The baud rate, then whether the programmer takes binary
+//                frames, and block writes as well, and frames its replies
+//                too, then the device type
+//              ]
 // *****************************************************************************
 void
-guiMainWindow::initResponse(const QString &s)
+guiMainWindow::initResponse(const initResult &r)
 {
     int32_t baudRate = ui.baudRate->currentText().toInt();
+    QString devType = ui.deviceType->currentText();
+
+    // Nothing back from the U, or nothing that made sense
+    if (r.divisor < 0) {
+        reportFailure(r);
+        return;
+    }
 
     clearText();
-    bool ok = true;
-    int32_t val = 20.0e6 / (4 * (s.toInt(&ok) + 1));
-    if (std::abs(100 * (val - baudRate) / baudRate) < 5) {
-        QString ss = QString("Initialised serial link to %1 baud").arg(baudRate);
-        appendText(ss);
+    if (r.baudOk) {
+        appendText(QString("Initialised serial link to %1 baud").arg(baudRate));
     }
     else {
-        QString ss = QString("Error, serial link not %1 baud").arg(baudRate);
-        appendText(ss);
+        appendText(QString("Error, serial link not %1 baud").arg(baudRate));
     }
     m_initOK = true;
 
-    if (ok == true) {
-        // Enable the buttons
-        ui.checkButton->setEnabled(true);
-        ui.readButton->setEnabled(true);
-        ui.writeButton->setEnabled(true);
-        ui.verifyButton->setEnabled(true);
-        ui.resetButton->setEnabled(true);
-        ui.initButton->setEnabled(false);
-        statusBar()->showMessage("Initialise OK");
+    // Enable the buttons
+    updateActions();
+    statusBar()->showMessage("Initialise OK");
+
+    if (r.level >= 3) {
+        appendText(QString("Using binary transfers, block writes and framed replies"));
+    }
+    else if (r.level == 2) {
+        appendText(QString("Using binary transfers and block writes"));
     }
     else {
-        serialError(QString("Failed to initialise serial link to %1 baud").arg(baudRate));
+        appendText(r.level == 1 ? QString("Using binary transfers") : QString("Using ASCII transfers"));
     }
-}
 
-// *****************************************************************************
-// Function     [ typeResponse ]
-// Description  [ The response string should be the device type ]
-// *****************************************************************************
-void
-guiMainWindow::typeResponse(const QString& s)
-{
-    QString devType = ui.deviceType->currentText();
-    if (s == "OK") {
+    if (reportFailure(r)) {
+        return;
+    }
+    if (r.typeSet) {
         statusBar()->showMessage("Init OK");
         appendText(QString("Set device type to %1").arg(devType));
     }
-    else {
-        serialError(QString("Bad device type %1").arg(devType));
-    }
-    
     setLedColour(Qt::green);
 }
 
@@ -373,35 +761,25 @@ guiMainWindow::read()
         qApp->processEvents();
     }
 
-    QString portName = ui.serialPort->currentText();
-    int32_t timeout = ui.timeOut->value() * 1000;
-    int32_t baudRate = ui.baudRate->currentText().toInt();
-    int32_t flowControl = getFlowControl();
-    QString devType = ui.deviceType->currentText();
-
-    readThread read_thread;
-    QObject::connect(&read_thread, SIGNAL(error(const QString &)), this, SLOT(serialError(const QString &)));
-    QObject::connect(&read_thread, SIGNAL(timeout(const QString &)), this, SLOT(serialTimeout(const QString&)));
-    QObject::connect(&read_thread, SIGNAL(response(const QString &)), this, SLOT(readResponse(const QString&)));
-    read_thread.transaction(portName,
-                            CMD_READ,
-                            devType,
-                            timeout,
-                            baudRate,
-                            flowControl);
+    whenDone(m_programmer->read(settings()), [this](const readResult &r) {
+        readResponse(r);
+    });
 }
 
 // *****************************************************************************
 // Function     [ readResponse ]
-// Description  [ The PIC response is the data, already formatted.
-//                It might be better to receive raw data and format it here.
-//              ]
+// Description  [ The bytes read, laid out as the PIC's ASCII dump always was ]
 // *****************************************************************************
 void
-guiMainWindow::readResponse(const QString &s)
+guiMainWindow::readResponse(const readResult &r)
 {
+    if (reportFailure(r)) {
+        return;
+    }
+    std::string text;
+    wireDumpText(reinterpret_cast<const uint8_t *>(r.data.constData()), (size_t) r.data.size(), text);
     clearText();
-    appendText(s);
+    appendText(QString::fromLatin1(text.data(), (qsizetype) text.size()));
     statusBar()->showMessage("Ready");
     setLedColour(Qt::green);
 }
@@ -423,68 +801,29 @@ guiMainWindow::check()
         qApp->processEvents();
     }
 
-    QString portName = ui.serialPort->currentText();
-    int32_t timeout = ui.timeOut->value() * 1000;
-    int32_t baudRate = ui.baudRate->currentText().toInt();
-    int32_t flowControl = getFlowControl();
-    QString devType = ui.deviceType->currentText();
-
-    readThread read_thread;
-    QObject::connect(&read_thread, SIGNAL(error(const QString &)), this, SLOT(serialError(const QString &)));
-    QObject::connect(&read_thread, SIGNAL(timeout(const QString &)), this, SLOT(serialTimeout(const QString&)));
-    QObject::connect(&read_thread, SIGNAL(response(const QString &)), this, SLOT(checkResponse(const QString&)));
-    read_thread.transaction(portName,
-                            CMD_READ,
-                            devType,
-                            timeout,
-                            baudRate,
-                            flowControl);
+    whenDone(m_programmer->blankCheck(settings()), [this](const checkResult &r) {
+        checkResponse(r);
+    });
 }
 
 // *****************************************************************************
 // Function     [ checkResponse ]
-// Description  [ Check the read data is 0x00 or 0xff depending on devType ]
+// Description  [ ]
 // *****************************************************************************
 void
-guiMainWindow::checkResponse(const QString &response)
+guiMainWindow::checkResponse(const checkResult &r)
 {
-    QString devType = ui.deviceType->currentText();
-
-    // Check all bytes read
-    clearText();
-    int32_t fails=0;
-
-    // Go thru all response data, checking bytes are 0xff
-    for (int32_t j=6; j < response.size(); j+=6) {
-        // += 6 is to skip addr e.g. '0000: '
-        for (int32_t i=0; i < 16; ++i) {
-            QString ss = response.mid(j, 2);
-            // Convert to hex char
-            bool ok = false;
-            uint8_t dev_chr = ss.toInt(&ok, 16);
-            // Compare with 0xff for all but 8748 which erases to 0x00
-            if (devType == "8748" || devType == "8749") {
-                if (0x00 != dev_chr) {
-                    fails++;
-                }
-            }
-            else {
-                if (0xff != dev_chr) {
-                    fails++;
-                }
-            }
-            j += 3;
-        }
+    if (reportFailure(r)) {
+        return;
     }
-
-    // for now just check if we got some
-    if (fails == 0) {
+    clearText();
+    if (r.fails == 0) {
         statusBar()->showMessage("Check OK");
         appendText(QString("Blank check passed"));
     }
     else {
         statusBar()->showMessage("Check failed");
-        appendText(QString("Blank check failed for %1 bytes").arg(fails));
+        appendText(QString("Blank check failed for %1 bytes").arg(r.fails));
     }
 
     setLedColour(Qt::green);
@@ -492,7 +831,9 @@ guiMainWindow::checkResponse(const QString &response)
 
 // *****************************************************************************
 // Function     [ write ]
-// Description  [ Write the data we read in from a hex file to the PIC ]
+// Description  [ Write the data we read in from a hex file to the PIC, and
+//                if asked verify it straight after, in the same job.
+//              ]
 // *****************************************************************************
 void
 guiMainWindow::write()
@@ -501,175 +842,48 @@ guiMainWindow::write()
         QMessageBox::critical(this, "Baud rate", "Init baud rate first!", QMessageBox::Ok);
         return;
     }
-    if (m_HexFile->size() > 0) {
-        QString portName = ui.serialPort->currentText();
-        int32_t timeout = ui.timeOut->value() * 1000;
-        int32_t baudRate = ui.baudRate->currentText().toInt();
-        int32_t flowControl = getFlowControl();
-        QString devType = ui.deviceType->currentText();
-
-        statusBar()->showMessage(QString("Writing to DUT"));
-        setLedColour(Qt::red);
-        initProgress();
-        qApp->processEvents();
-
-        if (devType == "8755" || devType == "8748" || devType == "8749") {
-
-            // Check hex file size is 2kb
-            if ((devType == "8755") && (m_HexFile->size() > 2048)) {
-                clearText();
-                appendText("HEX file size is greater than 2048 bytes!\n");
-                return;
-            }
-            if ((devType == "8748") && (m_HexFile->size() > 1024)) {
-                clearText();
-                appendText("HEX file size is greater than 1024 bytes!\n");
-                return;
-            }
-            if ((devType == "8749") && (m_HexFile->size() > 2048)) {
-                clearText();
-                appendText("HEX file size is greater than 1024 bytes!\n");
-                return;
-            }
-
-            QObject::connect(&e8755_thread, SIGNAL(error(const QString&)), this, SLOT(serialError(const QString&)));
-            QObject::connect(&e8755_thread, SIGNAL(timeout(const QString&)), this, SLOT(serialTimeout(const QString&)));
-            QObject::connect(&e8755_thread, SIGNAL(response(const QString&)), this, SLOT(writeResponse(const QString&)));
-            QObject::connect(&e8755_thread, SIGNAL(progress(int32_t)), this, SLOT(updateProgress(int32_t)));
-            QObject::connect(&e8755_thread, SIGNAL(finished()), this, SLOT(writeFinished()));
-            e8755_thread.transaction(portName,
-                CMD_READ,
-                devType,
-                timeout,
-                baudRate,
-                flowControl,
-                m_HexFile);
-        }
-
-        else if (devType == "2708") {
-
-            // Check hex file size is 1kb
-            if (m_HexFile->size() > 1024) {
-                clearText();
-                appendText("HEX file size is greater than 1024 bytes!\n");
-                return;
-            }
-
-            QObject::connect(&e2708_thread, SIGNAL(error(const QString&)), this, SLOT(serialError(const QString&)));
-            QObject::connect(&e2708_thread, SIGNAL(timeout(const QString&)), this, SLOT(serialTimeout(const QString&)));
-            QObject::connect(&e2708_thread, SIGNAL(response(const QString&)), this, SLOT(writeResponse(const QString&)));
-            QObject::connect(&e2708_thread, SIGNAL(progress(int32_t)), this, SLOT(updateProgress(int32_t)));
-            QObject::connect(&e2708_thread, SIGNAL(finished()), this, SLOT(writeFinished()));
-            e2708_thread.transaction(portName,
-                CMD_READ,
-                devType,
-                timeout,
-                baudRate,
-                flowControl,
-                m_HexFile);
-        }
-
-        else if (devType == "TMS2716") {
-
-            // Check hex file size is 2kb
-            if (m_HexFile->size() > 2048) {
-                clearText();
-                appendText("HEX file size is greater than 2048 bytes!\n");
-                return;
-            }
-
-            QObject::connect(&t2716_thread, SIGNAL(error(const QString&)), this, SLOT(serialError(const QString&)));
-            QObject::connect(&t2716_thread, SIGNAL(timeout(const QString&)), this, SLOT(serialTimeout(const QString&)));
-            QObject::connect(&t2716_thread, SIGNAL(response(const QString&)), this, SLOT(writeResponse(const QString&)));
-            QObject::connect(&t2716_thread, SIGNAL(progress(int32_t)), this, SLOT(updateProgress(int32_t)));
-            QObject::connect(&t2716_thread, SIGNAL(finished()), this, SLOT(writeFinished()));
-            t2716_thread.transaction(portName,
-                CMD_READ,
-                devType,
-                timeout,
-                baudRate,
-                flowControl,
-                m_HexFile);
-        }
-
-        else if (devType == "2716") {
-
-            // Check hex file size is 2kb
-            if (m_HexFile->size() > 2048) {
-                clearText();
-                appendText("HEX file size is greater than 2048 bytes!\n");
-                return;
-            }
+    if (m_HexFile->size() == 0) {
+        clearText();
+        appendText("No HEX data - please open a HEX file!\n");
+        return;
+    }
 
-            QObject::connect(&e2716_thread, SIGNAL(error(const QString&)), this, SLOT(serialError(const QString&)));
-            QObject::connect(&e2716_thread, SIGNAL(timeout(const QString&)), this, SLOT(serialTimeout(const QString&)));
-            QObject::connect(&e2716_thread, SIGNAL(response(const QString&)), this, SLOT(writeResponse(const QString&)));
-            QObject::connect(&e2716_thread, SIGNAL(progress(int32_t)), this, SLOT(updateProgress(int32_t)));
-            QObject::connect(&e2716_thread, SIGNAL(finished()), this, SLOT(writeFinished()));
-            e2716_thread.transaction(portName,
-                CMD_READ,
-                devType,
-                timeout,
-                baudRate,
-                flowControl,
-                m_HexFile);
-        }
+    statusBar()->showMessage(QString("Writing to DUT"));
+    setLedColour(Qt::red);
+    initProgress();
+    qApp->processEvents();
 
-        else if (devType == "2532") {
+    // The operation has its own copy, the image as it is now
+    const std::shared_ptr<const hexImage> image = std::make_shared<const hexImage>(m_HexFile->image());
 
-            // Check hex file size is 4kb
-            if (m_HexFile->size() > 4096) {
-                clearText();
-                appendText("HEX file size is greater than 4096 bytes!\n");
+    if (ui.verifyAfterWrite->isChecked()) {
+        QFuture<pipelineResult> future = m_programmer->run(settings(), programmerPipeline().write().verify(), image);
+        QFutureWatcher<pipelineResult> *watcher = whenDone(future, [this](const pipelineResult &r) {
+            writeFinished();
+            if (r.steps == 0) {
+                reportFailure(r);
                 return;
             }
-
-            QObject::connect(&e2532_thread, SIGNAL(error(const QString&)), this, SLOT(serialError(const QString&)));
-            QObject::connect(&e2532_thread, SIGNAL(timeout(const QString&)), this, SLOT(serialTimeout(const QString&)));
-            QObject::connect(&e2532_thread, SIGNAL(response(const QString&)), this, SLOT(writeResponse(const QString&)));
-            QObject::connect(&e2532_thread, SIGNAL(progress(int32_t)), this, SLOT(updateProgress(int32_t)));
-            QObject::connect(&e2532_thread, SIGNAL(finished()), this, SLOT(writeFinished()));
-            e2532_thread.transaction(portName,
-                CMD_READ,
-                devType,
-                timeout,
-                baudRate,
-                flowControl,
-                m_HexFile);
-        }
-
-        else if (devType == "2732") {
-
-            // Check hex file size is 4kb
-            if (m_HexFile->size() > 4096) {
-                clearText();
-                appendText("HEX file size is greater than 4096 bytes!\n");
-                return;
+            writeResponse(r.write);
+            if (r.steps > 1) {
+                verifyResponse(r.verify);
             }
-
-            QObject::connect(&e2732_thread, SIGNAL(error(const QString&)), this, SLOT(serialError(const QString&)));
-            QObject::connect(&e2732_thread, SIGNAL(timeout(const QString&)), this, SLOT(serialTimeout(const QString&)));
-            QObject::connect(&e2732_thread, SIGNAL(response(const QString&)), this, SLOT(writeResponse(const QString&)));
-            QObject::connect(&e2732_thread, SIGNAL(progress(int32_t)), this, SLOT(updateProgress(int32_t)));
-            QObject::connect(&e2732_thread, SIGNAL(finished()), this, SLOT(writeFinished()));
-            e2732_thread.transaction(portName,
-                CMD_READ,
-                devType,
-                timeout,
-                baudRate,
-                flowControl,
-                m_HexFile);
-        }
+        });
+        QObject::connect(watcher, &QFutureWatcher<pipelineResult>::progressValueChanged, this, &guiMainWindow::updateProgress);
     }
     else {
-        clearText();
-        appendText("No HEX data - please open a HEX file!\n");
+        QFutureWatcher<writeResult> *watcher = whenDone(m_programmer->write(settings(), image),
+                                                         [this](const writeResult &r) {
+            writeFinished();
+            writeResponse(r);
+        });
+        QObject::connect(watcher, &QFutureWatcher<writeResult>::progressValueChanged, this, &guiMainWindow::updateProgress);
     }
 }
 
 // *****************************************************************************
 // Function     [ writeFinished ]
-// Description  [ Wite thread has finished ]
+// Description  [ Wite has finished ]
 // *****************************************************************************
 void
 guiMainWindow::writeFinished()
@@ -695,101 +909,109 @@ guiMainWindow::verify()
         qApp->processEvents();
     }
 
-    QString portName = ui.serialPort->currentText();
-    int32_t timeout = ui.timeOut->value() * 1000;
-    int32_t baudRate = ui.baudRate->currentText().toInt();
-    int32_t flowControl = getFlowControl();
-    QString devType = ui.deviceType->currentText();
-
-    readThread read_thread;
-    QObject::connect(&read_thread, SIGNAL(error(const QString&)), this, SLOT(serialError(const QString&)));
-    QObject::connect(&read_thread, SIGNAL(timeout(const QString&)), this, SLOT(serialTimeout(const QString&)));
-    QObject::connect(&read_thread, SIGNAL(response(const QString&)), this, SLOT(verifyResponse(const QString&)));
-    read_thread.transaction(portName,
-        CMD_READ,
-        devType,
-        timeout,
-        baudRate,
-        flowControl);
+    const std::shared_ptr<const hexImage> image = std::make_shared<const hexImage>(m_HexFile->image());
+    whenDone(m_programmer->verify(settings(), image), [this](const verifyResult &r) {
+        verifyResponse(r);
+    });
 }
 
 // *****************************************************************************
 // Function     [ verifyResponse ]
-// Description  [ ]
+// Description  [ Show the image with the bytes that differ on the device in
+//                red, and a list of the ranges.
+//              ]
 // *****************************************************************************
 void
-guiMainWindow::verifyResponse(const QString& s)
+guiMainWindow::verifyResponse(const verifyResult &result)
 {
-    if (s.size() > 2) {
-        clearText();
-        // Compare each char of s to the hexfile
-        std::vector<hexDataChunk> hexdata = m_HexFile->hexData();
-        int32_t j = 0;
-        int32_t bad = 0;
-        bool ok = true;
-        for (auto iter = hexdata.begin(); iter != hexdata.end(); ++iter, ++j) {
-            hexDataChunk chunk = *iter;
-            // Write the address of the chunk
-            QString ss; ss.setNum(chunk.address(), 16);
-            ui.textEdit->insertPlainText(QString("%1: ").arg(ss, 4, QChar('0')));
-            j += 6; // skip addr e.g. '0000: '
-            std::vector<uint8_t> data = chunk.data();
-            for (int32_t i = 0; i < data.size(); ++i) {
-                // chunk's hex characters given by data.at(i)
-                uint8_t hex_chr = data.at(i);
-                // dev's data is 2 chars
-                QString ss = s.mid(j, 2);
-                // Convert to hex char
-                uint8_t dev_chr = ss.toInt(&ok, 16);
-                // Compare the data. If equal, write the data,
-                // if not equal, write the data in red.
-                if (hex_chr == dev_chr) {
-                    ui.textEdit->insertPlainText(QString("%1 ").arg(ss, 2, QChar('0')));
-                }
-                else {
-                    ui.textEdit->setTextColor(Qt::red);
-                    ui.textEdit->insertPlainText(QString("%1 ").arg(ss, 2, QChar('0')));
-                    ui.textEdit->setTextColor(Qt::black);
-                    bad++;
-                }
-                // increment j pointer
-                if (i == 15) {
-                    j += 2;
-                }
-                else {
-                    j += 3;
+    if (reportFailure(result)) {
+        return;
+    }
+    if (!result.data.isEmpty() && result.image) {
+        // The image as it was verified, which may no longer be the one loaded
+        const hexImage &image = *result.image;
+        const hexSpanView spans = image.spans();
+        const hexDiffReport &report = result.report;
+        const std::vector<uint8_t> &device = result.device;
+        const std::vector<uint32_t> &unread = result.unread;
+
+        if (result.identical()) {
+            showImage(image);
+            statusBar()->showMessage(QString("DUT verified correct, CRC32 %1.")
+                                     .arg(crc32(image.data(), image.extent()), 8, 16, QChar('0')));
+            setLedColour(Qt::green);
+            return;
+        }
+
+        // Show the device's bytes 16 to a line, with runs that differ from
+        // the hex file in red, built up and handed over in one go
+        QByteArray html("<div style=\"white-space:pre\">");
+        html.reserve((qsizetype) (image.size() * 4 + report.ranges.size() * 48));
+        size_t r = 0;
+        size_t u = 0;
+        for (auto iter = spans.begin(); iter != spans.end(); ++iter) {
+            const hexSpan &span = *iter;
+            size_t i = 0;
+            while (i < span.size) {
+                char address[16];
+                int32_t n = std::snprintf(address, sizeof(address), "%04x: ", span.address + (uint32_t) i);
+                html.append(address, n);
+                bool red = false;
+                do {
+                    uint32_t a = span.address + (uint32_t) i;
+                    while (r < report.ranges.size() && report.ranges[r].address + report.ranges[r].size <= a) {
+                        ++r;
+                    }
+                    while (u < unread.size() && unread[u] < a) {
+                        ++u;
+                    }
+                    bool missing = u < unread.size() && unread[u] == a;
+                    bool bad = missing || (r < report.ranges.size() && report.ranges[r].address <= a);
+                    if (bad != red) {
+                        html.append(bad ? "<font color=\"red\">" : "</font>");
+                        red = bad;
+                    }
+                    char text[3] = { '?', '?', ' ' };
+                    if (!missing) {
+                        hexEncodeByte(device[a - image.baseAddress()], text);
+                    }
+                    html.append(text, 3);
+                    ++i;
+                } while (i < span.size && ((span.address + i) & 0xf) != 0);
+                if (red) {
+                    html.append("</font>");
                 }
+                html.append('\n');
             }
-            ui.textEdit->insertPlainText("\n");
         }
-        if (bad != 0) {
-            statusBar()->showMessage(QString("DUT has %1 differences with hex file!").arg(bad));
-        }
-        else {
-            statusBar()->showMessage("DUT verified correct.");
+        html.append("</div>");
+
+        clearText();
+        ui.textEdit->insertHtml(QString::fromLatin1(html));
+        appendText(diffText(report));
+        if (!unread.empty()) {
+            appendText(QString("%1 bytes missing from the device's response").arg(unread.size()));
         }
+        statusBar()->showMessage(QString("DUT has %1 differences with hex file!").arg(report.bytes + unread.size()));
     }
     setLedColour(Qt::green);
 }
 
 // *****************************************************************************
 // Function     [ writeResponse ]
-// Description  [ ]
+// Description  [ How the burn kept time, then how it went ]
 // *****************************************************************************
 void
-guiMainWindow::writeResponse(const QString &s)
+guiMainWindow::writeResponse(const writeResult &r)
 {
-    if (s.startsWith("OK")) {
-        statusBar()->showMessage("Write OK");
-        QStringList bc = s.split(' ');
-        int32_t byte_count = bc.at(1).toInt();
-        appendText(QString("Wrote %1 bytes").arg(byte_count));
+    for (const QString &line : r.pacing) {
+        appendText(line);
     }
-    else {
-        QStringList bc = s.split(' ');
-        int32_t byte_count = bc.at(1).toInt();
-        serialError(QString("Failed to write %1 bytes)").arg(byte_count));
+    if (reportFailure(r)) {
+        return;
     }
+    statusBar()->showMessage("Write OK");
+    appendText(QString("Wrote %1 bytes").arg(r.bytes));
 }
 
 // *****************************************************************************
@@ -8,19 +8,14 @@
 // *****************************************************************************
 
 #include <QtWidgets/QMainWindow>
+#include <QFutureWatcher>
 #include <QSerialPort>
 #include <QProgressBar>
 #include "ui_guiMainWindow.h"
-#include "initThread.h"
 #include "hexFile.h"
+#include "programmer.h"
 #include "qLedWidget.h"
-#include "readThread.h"
-#include "E8755Thread.h"
-#include "E2708Thread.h"
-#include "E2716Thread.h"
-#include "TMS2716Thread.h"
-#include "E2532Thread.h"
-#include "E2732Thread.h"
+#include "serialHub.h"
 
 // *****************************************************************************
 // Class        [ guiMainWindow ]
@@ -37,6 +32,8 @@ public:
 public slots:
     void                   openHexFile();
     void                   saveHexFile();
+    void                   mergeFiles();
+    void                   compareFiles();
     void                   init();
     void                   quit();
     void                   read();
@@ -49,14 +46,6 @@ public slots:
     void                   serialError(const QString &);
     void                   serialTimeout(const QString &);
 
-    // Slots to receive cmd responses
-    void                   readResponse(const QString &);
-    void                   initResponse(const QString &);
-    void                   typeResponse(const QString &);
-    void                   checkResponse(const QString &);
-    void                   writeResponse(const QString&);
-    void                   verifyResponse(const QString&);
-
     void                   initProgress() { m_progressBar->reset(); m_progressBar->show(); }
     void                   updateProgress(int32_t val) { m_progressBar->setValue(val); }
     void                   writeFinished();
@@ -71,7 +60,24 @@ public slots:
 
 private:
     size_t                 size() {return m_HexFile->size();}
+    void                   showImage();
+    void                   showImage(const hexImage &image);
+    void                   showDigests();
+    void                   showDiagnostics(const hexFile &file, const QString &fileName);
+    const hexFormat      * readFile(const QString &fileName, hexFile &file);
     int32_t                getFlowControl();
+    programmerSettings     settings();
+
+    // The programmer's operations, and their results
+    template <class Result, class Func>
+    QFutureWatcher<Result> * whenDone(const QFuture<Result> &future, Func func);
+    void                   updateActions();
+    bool                   reportFailure(const programmerResult &r);
+    void                   initResponse(const initResult &r);
+    void                   readResponse(const readResult &r);
+    void                   checkResponse(const checkResult &r);
+    void                   writeResponse(const writeResult &r);
+    void                   verifyResponse(const verifyResult &r);
 
     // ui
     Ui::guiMainWindowClass ui;
@@ -88,17 +94,18 @@ private:
     QProgressBar         * m_progressBar;
 
     bool                   m_initOK;
+    // Operations queued or under way. The programming and file actions
+    // are off until there are none.
+    int32_t                m_busy;
 
     // Device type
     QString                m_devType;
 
-    // Threads
-    E8755Thread             e8755_thread;
-    E2708Thread             e2708_thread;
-    T2716Thread             t2716_thread;
-    E2716Thread             e2716_thread;
-    E2532Thread             e2532_thread;
-    E2732Thread             e2732_thread;
+    // The serial session, every command's I/O on the one open port, in a
+    // thread of its own
+    QThread                m_ioThread;
+    serialHub            * m_serialHub;
+    programmer           * m_programmer;
 };
 
 #endif /* GUIMAINWINDOW_H */
@@ -0,0 +1,50 @@
+#ifndef HEXBITS_H
+#define HEXBITS_H
+
+// *****************************************************************************
+// File         [ hexBits.h ]
+// Description  [ Bit scanning and counting on a word, as the compiler's
+//                builtins or MSVC's intrinsics. Shared by the image's
+//                occupancy bitmap and the diff's compare masks.
+//              ]
+// Author       [ Keith Sabine ]
+// *****************************************************************************
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// *****************************************************************************
+// Function     [ hexLowestBit ]
+// Description  [ Index of the lowest set bit of a non-zero word ]
+// *****************************************************************************
+inline size_t
+hexLowestBit(uint64_t w)
+{
+#if defined(_MSC_VER)
+    unsigned long i;
+    _BitScanForward64(&i, w);
+    return i;
+#else
+    return __builtin_ctzll(w);
+#endif
+}
+
+// *****************************************************************************
+// Function     [ hexBitCount ]
+// Description  [ Number of set bits in a word ]
+// *****************************************************************************
+inline size_t
+hexBitCount(uint64_t w)
+{
+#if defined(_MSC_VER)
+    return __popcnt64(w);
+#else
+    return __builtin_popcountll(w);
+#endif
+}
+
+#endif /* HEXBITS_H */
@@ -0,0 +1,332 @@
+// *****************************************************************************
+// File         [ hexCodec.cpp ]
+// Description  [ Conversion between bytes and ASCII hex pairs ]
+// Author       [ Keith Sabine ]
+// *****************************************************************************
+
+#include "hexCodec.h"
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define HEXCODEC_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define HEXCODEC_AVX2
+#else
+#define HEXCODEC_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+const hexTables g_HexTables;
+
+// *****************************************************************************
+// Function     [ constructor ]
+// Description  [ ]
+// *****************************************************************************
+hexTables::hexTables()
+{
+    static const char lo[] = "0123456789abcdef";
+    static const char up[] = "0123456789ABCDEF";
+
+    std::memset(nibble, 0xff, sizeof(nibble));
+    for (int32_t i = 0; i < 16; ++i) {
+        nibble[(uint8_t) lo[i]] = (uint8_t) i;
+        nibble[(uint8_t) up[i]] = (uint8_t) i;
+    }
+    for (int32_t b = 0; b < 256; ++b) {
+        lower[b][0] = lo[b >> 4];
+        lower[b][1] = lo[b & 15];
+        upper[b][0] = up[b >> 4];
+        upper[b][1] = up[b & 15];
+    }
+}
+
+// *****************************************************************************
+// Function     [ encodeScalar ]
+// Description  [ ]
+// *****************************************************************************
+static void
+encodeScalar(const uint8_t *src, size_t n, char *dst, bool upper)
+{
+    const char (*table)[2] = upper ? g_HexTables.upper : g_HexTables.lower;
+    for (size_t i = 0; i < n; ++i) {
+        dst[2 * i]     = table[src[i]][0];
+        dst[2 * i + 1] = table[src[i]][1];
+    }
+}
+
+// *****************************************************************************
+// Function     [ decodeScalar ]
+// Description  [ ]
+// *****************************************************************************
+static bool
+decodeScalar(const char *src, size_t n, uint8_t *dst)
+{
+    uint8_t bad = 0;
+    for (size_t i = 0; i < n; ++i) {
+        uint8_t hi = g_HexTables.nibble[(uint8_t) src[2 * i]];
+        uint8_t lo = g_HexTables.nibble[(uint8_t) src[2 * i + 1]];
+        bad |= hi | lo;
+        dst[i] = (uint8_t) ((hi << 4) | lo);
+    }
+    return bad < 16;
+}
+
+#if defined(HEXCODEC_X86)
+
+// *****************************************************************************
+// Function     [ encodeSSE2 ]
+// Description  [ 16 bytes to 32 characters per step. Each nibble n becomes
+//                n + '0', plus the gap up to 'a' (or 'A') when n > 9.
+//              ]
+// *****************************************************************************
+static void
+encodeSSE2(const uint8_t *src, size_t n, char *dst, bool upper)
+{
+    const __m128i mask  = _mm_set1_epi8(0x0f);
+    const __m128i nine  = _mm_set1_epi8(9);
+    const __m128i zero  = _mm_set1_epi8('0');
+    const __m128i alpha = _mm_set1_epi8(upper ? 'A' - '0' - 10 : 'a' - '0' - 10);
+
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i v  = _mm_loadu_si128((const __m128i *) (src + i));
+        __m128i hi = _mm_and_si128(_mm_srli_epi16(v, 4), mask);
+        __m128i lo = _mm_and_si128(v, mask);
+        hi = _mm_add_epi8(_mm_add_epi8(hi, zero), _mm_and_si128(_mm_cmpgt_epi8(hi, nine), alpha));
+        lo = _mm_add_epi8(_mm_add_epi8(lo, zero), _mm_and_si128(_mm_cmpgt_epi8(lo, nine), alpha));
+        _mm_storeu_si128((__m128i *) (dst + 2 * i),      _mm_unpacklo_epi8(hi, lo));
+        _mm_storeu_si128((__m128i *) (dst + 2 * i + 16), _mm_unpackhi_epi8(hi, lo));
+    }
+    encodeScalar(src + i, n - i, dst + 2 * i, upper);
+}
+
+// *****************************************************************************
+// Function     [ nibblesSSE2 ]
+// Description  [ Hex value of 16 characters, and a mask of the valid ones ]
+// *****************************************************************************
+static inline __m128i
+nibblesSSE2(__m128i v, __m128i &valid)
+{
+    __m128i digit = _mm_sub_epi8(v, _mm_set1_epi8('0'));
+    __m128i isDigit = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('0' - 1)),
+                                    _mm_cmplt_epi8(v, _mm_set1_epi8('9' + 1)));
+    __m128i l = _mm_or_si128(v, _mm_set1_epi8(0x20));
+    __m128i letter = _mm_sub_epi8(l, _mm_set1_epi8('a' - 10));
+    __m128i isLetter = _mm_and_si128(_mm_cmpgt_epi8(l, _mm_set1_epi8('a' - 1)),
+                                     _mm_cmplt_epi8(l, _mm_set1_epi8('f' + 1)));
+    valid = _mm_or_si128(isDigit, isLetter);
+    return _mm_or_si128(_mm_and_si128(isDigit, digit), _mm_and_si128(isLetter, letter));
+}
+
+// *****************************************************************************
+// Function     [ decodeSSE2 ]
+// Description  [ 32 characters to 16 bytes per step. Adjacent nibbles are
+//                joined within each 16 bit lane, then the lanes packed.
+//              ]
+// *****************************************************************************
+static bool
+decodeSSE2(const char *src, size_t n, uint8_t *dst)
+{
+    const __m128i lowByte = _mm_set1_epi16(0x00ff);
+
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i va, vb;
+        __m128i a = nibblesSSE2(_mm_loadu_si128((const __m128i *) (src + 2 * i)), va);
+        __m128i b = nibblesSSE2(_mm_loadu_si128((const __m128i *) (src + 2 * i + 16)), vb);
+        if (_mm_movemask_epi8(_mm_and_si128(va, vb)) != 0xffff) {
+            return false;
+        }
+        a = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(a, lowByte), 4), _mm_srli_epi16(a, 8));
+        b = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(b, lowByte), 4), _mm_srli_epi16(b, 8));
+        _mm_storeu_si128((__m128i *) (dst + i), _mm_packus_epi16(a, b));
+    }
+    return decodeScalar(src + 2 * i, n - i, dst + i);
+}
+
+// *****************************************************************************
+// Function     [ encodeAVX2 ]
+// Description  [ As encodeSSE2, 32 bytes per step. The unpacks work within
+//                128 bit lanes, so the halves are swapped back into order.
+//              ]
+// *****************************************************************************
+HEXCODEC_AVX2 static void
+encodeAVX2(const uint8_t *src, size_t n, char *dst, bool upper)
+{
+    const __m256i mask  = _mm256_set1_epi8(0x0f);
+    const __m256i nine  = _mm256_set1_epi8(9);
+    const __m256i zero  = _mm256_set1_epi8('0');
+    const __m256i alpha = _mm256_set1_epi8(upper ? 'A' - '0' - 10 : 'a' - '0' - 10);
+
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i v  = _mm256_loadu_si256((const __m256i *) (src + i));
+        __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), mask);
+        __m256i lo = _mm256_and_si256(v, mask);
+        hi = _mm256_add_epi8(_mm256_add_epi8(hi, zero), _mm256_and_si256(_mm256_cmpgt_epi8(hi, nine), alpha));
+        lo = _mm256_add_epi8(_mm256_add_epi8(lo, zero), _mm256_and_si256(_mm256_cmpgt_epi8(lo, nine), alpha));
+        __m256i x = _mm256_unpacklo_epi8(hi, lo);
+        __m256i y = _mm256_unpackhi_epi8(hi, lo);
+        _mm256_storeu_si256((__m256i *) (dst + 2 * i),      _mm256_permute2x128_si256(x, y, 0x20));
+        _mm256_storeu_si256((__m256i *) (dst + 2 * i + 32), _mm256_permute2x128_si256(x, y, 0x31));
+    }
+    encodeSSE2(src + i, n - i, dst + 2 * i, upper);
+}
+
+// *****************************************************************************
+// Function     [ nibblesAVX2 ]
+// Description  [ ]
+// *****************************************************************************
+HEXCODEC_AVX2 static inline __m256i
+nibblesAVX2(__m256i v, __m256i &valid)
+{
+    __m256i digit = _mm256_sub_epi8(v, _mm256_set1_epi8('0'));
+    __m256i isDigit = _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('0' - 1)),
+                                       _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), v));
+    __m256i l = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+    __m256i letter = _mm256_sub_epi8(l, _mm256_set1_epi8('a' - 10));
+    __m256i isLetter = _mm256_and_si256(_mm256_cmpgt_epi8(l, _mm256_set1_epi8('a' - 1)),
+                                        _mm256_cmpgt_epi8(_mm256_set1_epi8('f' + 1), l));
+    valid = _mm256_or_si256(isDigit, isLetter);
+    return _mm256_or_si256(_mm256_and_si256(isDigit, digit), _mm256_and_si256(isLetter, letter));
+}
+
+// *****************************************************************************
+// Function     [ decodeAVX2 ]
+// Description  [ As decodeSSE2, 64 characters to 32 bytes per step ]
+// *****************************************************************************
+HEXCODEC_AVX2 static bool
+decodeAVX2(const char *src, size_t n, uint8_t *dst)
+{
+    const __m256i lowByte = _mm256_set1_epi16(0x00ff);
+
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i va, vb;
+        __m256i a = nibblesAVX2(_mm256_loadu_si256((const __m256i *) (src + 2 * i)), va);
+        __m256i b = nibblesAVX2(_mm256_loadu_si256((const __m256i *) (src + 2 * i + 32)), vb);
+        if (_mm256_movemask_epi8(_mm256_and_si256(va, vb)) != -1) {
+            return false;
+        }
+        a = _mm256_or_si256(_mm256_slli_epi16(_mm256_and_si256(a, lowByte), 4), _mm256_srli_epi16(a, 8));
+        b = _mm256_or_si256(_mm256_slli_epi16(_mm256_and_si256(b, lowByte), 4), _mm256_srli_epi16(b, 8));
+        // packus interleaves the 128 bit lanes of a and b, so put them back
+        __m256i p = _mm256_packus_epi16(a, b);
+        _mm256_storeu_si256((__m256i *) (dst + i), _mm256_permute4x64_epi64(p, 0xd8));
+    }
+    return decodeSSE2(src + 2 * i, n - i, dst + i);
+}
+
+#endif // HEXCODEC_X86
+
+// *****************************************************************************
+// Function     [ hexHaveAVX2 ]
+// Description  [ ]
+// *****************************************************************************
+bool
+hexHaveAVX2()
+{
+#if !defined(HEXCODEC_X86)
+    return false;
+#elif defined(_MSC_VER)
+    int regs[4];
+    __cpuid(regs, 0);
+    if (regs[0] < 7) {
+        return false;
+    }
+    __cpuid(regs, 1);
+    bool osxsave = (regs[2] & (1 << 27)) != 0;
+    bool avx     = (regs[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 6) != 6) {
+        return false;
+    }
+    __cpuidex(regs, 7, 0);
+    return (regs[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+// *****************************************************************************
+// Class        [ hexKernels ]
+// Description  [ The bulk routines chosen for this CPU, picked once ]
+// *****************************************************************************
+struct hexKernels
+{
+    void                   (* encode)(const uint8_t *, size_t, char *, bool);
+    bool                   (* decode)(const char *, size_t, uint8_t *);
+    const char              * name;
+
+    hexKernels()
+    {
+#if defined(HEXCODEC_X86)
+        if (hexHaveAVX2()) {
+            encode = encodeAVX2;
+            decode = decodeAVX2;
+            name   = "AVX2";
+        }
+        else {
+            encode = encodeSSE2;
+            decode = decodeSSE2;
+            name   = "SSE2";
+        }
+#else
+        encode = encodeScalar;
+        decode = decodeScalar;
+        name   = "scalar";
+#endif
+    }
+};
+
+// *****************************************************************************
+// Function     [ kernels ]
+// Description  [ ]
+// *****************************************************************************
+static const hexKernels &
+kernels()
+{
+    static const hexKernels k;
+    return k;
+}
+
+// *****************************************************************************
+// Function     [ hexEncode ]
+// Description  [ ]
+// *****************************************************************************
+void
+hexEncode(const uint8_t *src, size_t n, char *dst, bool upper)
+{
+    if (n < 16) {
+        encodeScalar(src, n, dst, upper);
+    }
+    else {
+        kernels().encode(src, n, dst, upper);
+    }
+}
+
+// *****************************************************************************
+// Function     [ hexDecode ]
+// Description  [ ]
+// *****************************************************************************
+bool
+hexDecode(const char *src, size_t n, uint8_t *dst)
+{
+    if (n < 16) {
+        return decodeScalar(src, n, dst);
+    }
+    return kernels().decode(src, n, dst);
+}
+
+// *****************************************************************************
+// Function     [ hexCodecName ]
+// Description  [ ]
+// *****************************************************************************
+const char *
+hexCodecName()
+{
+    return kernels().name;
+}
@@ -0,0 +1,72 @@
+#ifndef HEXCODEC_H
+#define HEXCODEC_H
+
+// *****************************************************************************
+// File         [ hexCodec.h ]
+// Description  [ Conversion between bytes and ASCII hex pairs. The bulk
+//                routines use AVX2 or SSE2 where the CPU has them, and a
+//                table driven loop otherwise.
+//              ]
+// Author       [ Keith Sabine ]
+// *****************************************************************************
+
+#include <cstddef>
+#include <cstdint>
+
+// *****************************************************************************
+// Class        [ hexTables ]
+// Description  [ Lookup tables shared by the scalar paths ]
+// *****************************************************************************
+struct hexTables
+{
+    // Hex value of an ASCII character, or 0xff if it isn't a hex digit
+    uint8_t                   nibble[256];
+    // Two character encodings of each byte, lower and upper case
+    char                      lower[256][2];
+    char                      upper[256][2];
+
+    hexTables();
+};
+
+extern const hexTables        g_HexTables;
+
+// *****************************************************************************
+// Function     [ hexEncodeByte ]
+// Description  [ Write one byte as two hex characters, no terminator ]
+// *****************************************************************************
+inline void
+hexEncodeByte(uint8_t b, char *dst, bool upper = false)
+{
+    const char *pair = upper ? g_HexTables.upper[b] : g_HexTables.lower[b];
+    dst[0] = pair[0];
+    dst[1] = pair[1];
+}
+
+// *****************************************************************************
+// Function     [ hexDecodePair ]
+// Description  [ Decode two hex characters. Returns false if either is bad. ]
+// *****************************************************************************
+inline bool
+hexDecodePair(const char *src, uint8_t &out)
+{
+    uint8_t hi = g_HexTables.nibble[(uint8_t) src[0]];
+    uint8_t lo = g_HexTables.nibble[(uint8_t) src[1]];
+    out = (uint8_t) ((hi << 4) | lo);
+    return (hi | lo) < 16;
+}
+
+// Encode n bytes from src as 2*n characters at dst.
+void                          hexEncode(const uint8_t *src, size_t n, char *dst, bool upper = false);
+
+// Decode 2*n characters from src into n bytes at dst. Returns false if any
+// character is not a hex digit, in which case dst is left undefined.
+bool                          hexDecode(const char *src, size_t n, uint8_t *dst);
+
+// The instruction set the bulk routines are using, for reports.
+const char                  * hexCodecName();
+
+// True if both the CPU and the OS support AVX2, for other SIMD routines
+// choosing their kernels.
+bool                          hexHaveAVX2();
+
+#endif /* HEXCODEC_H */
@@ -0,0 +1,415 @@
+// *****************************************************************************
+// File         [ hexDiff.cpp ]
+// Description  [ Implementation of the image comparison routines ]
+// Author       [ Keith Sabine ]
+// *****************************************************************************
+
+#include "hexDiff.h"
+#include "hexBits.h"
+#include "hexCodec.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define HEXDIFF_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#define HEXDIFF_AVX2
+#else
+#define HEXDIFF_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+// *****************************************************************************
+// Function     [ mismatchScalar ]
+// Description  [ ]
+// *****************************************************************************
+static size_t
+mismatchScalar(const uint8_t *a, const uint8_t *b, size_t n)
+{
+    size_t i = 0;
+    while (i < n && a[i] == b[i]) {
+        ++i;
+    }
+    return i;
+}
+
+// *****************************************************************************
+// Function     [ matchScalar ]
+// Description  [ ]
+// *****************************************************************************
+static size_t
+matchScalar(const uint8_t *a, const uint8_t *b, size_t n)
+{
+    size_t i = 0;
+    while (i < n && a[i] != b[i]) {
+        ++i;
+    }
+    return i;
+}
+
+#if defined(HEXDIFF_X86)
+
+// *****************************************************************************
+// Function     [ mismatchSSE2 ]
+// Description  [ 16 bytes per step. The compare gives a bit per equal byte,
+//                so the first clear bit is the first difference.
+//              ]
+// *****************************************************************************
+static size_t
+mismatchSSE2(const uint8_t *a, const uint8_t *b, size_t n)
+{
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i va = _mm_loadu_si128((const __m128i *) (a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i *) (b + i));
+        uint32_t equal = (uint32_t) _mm_movemask_epi8(_mm_cmpeq_epi8(va, vb));
+        if (equal != 0xffff) {
+            return i + hexLowestBit(~equal);
+        }
+    }
+    return i + mismatchScalar(a + i, b + i, n - i);
+}
+
+// *****************************************************************************
+// Function     [ matchSSE2 ]
+// Description  [ ]
+// *****************************************************************************
+static size_t
+matchSSE2(const uint8_t *a, const uint8_t *b, size_t n)
+{
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m128i va = _mm_loadu_si128((const __m128i *) (a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i *) (b + i));
+        uint32_t equal = (uint32_t) _mm_movemask_epi8(_mm_cmpeq_epi8(va, vb));
+        if (equal != 0) {
+            return i + hexLowestBit(equal);
+        }
+    }
+    return i + matchScalar(a + i, b + i, n - i);
+}
+
+// *****************************************************************************
+// Function     [ mismatchAVX2 ]
+// Description  [ 64 bytes per step while nothing differs, then narrow down ]
+// *****************************************************************************
+HEXDIFF_AVX2 static size_t
+mismatchAVX2(const uint8_t *a, const uint8_t *b, size_t n)
+{
+    size_t i = 0;
+    for (; i + 64 <= n; i += 64) {
+        __m256i e0 = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *) (a + i)),
+                                       _mm256_loadu_si256((const __m256i *) (b + i)));
+        __m256i e1 = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *) (a + i + 32)),
+                                       _mm256_loadu_si256((const __m256i *) (b + i + 32)));
+        if ((uint32_t) _mm256_movemask_epi8(_mm256_and_si256(e0, e1)) != 0xffffffffu) {
+            uint32_t equal = (uint32_t) _mm256_movemask_epi8(e0);
+            if (equal != 0xffffffffu) {
+                return i + hexLowestBit(~equal);
+            }
+            return i + 32 + hexLowestBit(~(uint32_t) _mm256_movemask_epi8(e1));
+        }
+    }
+    return i + mismatchSSE2(a + i, b + i, n - i);
+}
+
+// *****************************************************************************
+// Function     [ matchAVX2 ]
+// Description  [ ]
+// *****************************************************************************
+HEXDIFF_AVX2 static size_t
+matchAVX2(const uint8_t *a, const uint8_t *b, size_t n)
+{
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i va = _mm256_loadu_si256((const __m256i *) (a + i));
+        __m256i vb = _mm256_loadu_si256((const __m256i *) (b + i));
+        uint32_t equal = (uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(va, vb));
+        if (equal != 0) {
+            return i + hexLowestBit(equal);
+        }
+    }
+    return i + matchSSE2(a + i, b + i, n - i);
+}
+
+#endif // HEXDIFF_X86
+
+// *****************************************************************************
+// Class        [ diffKernels ]
+// Description  [ The compare routines chosen for this CPU, picked once ]
+// *****************************************************************************
+struct diffKernels
+{
+    size_t                 (* mismatch)(const uint8_t *, const uint8_t *, size_t);
+    size_t                 (* match)(const uint8_t *, const uint8_t *, size_t);
+
+    diffKernels()
+    {
+#if defined(HEXDIFF_X86)
+        if (hexHaveAVX2()) {
+            mismatch = mismatchAVX2;
+            match    = matchAVX2;
+        }
+        else {
+            mismatch = mismatchSSE2;
+            match    = matchSSE2;
+        }
+#else
+        mismatch = mismatchScalar;
+        match    = matchScalar;
+#endif
+    }
+};
+
+// *****************************************************************************
+// Function     [ kernels ]
+// Description  [ ]
+// *****************************************************************************
+static const diffKernels &
+kernels()
+{
+    static const diffKernels k;
+    return k;
+}
+
+// *****************************************************************************
+// Function     [ hexMismatch ]
+// Description  [ ]
+// *****************************************************************************
+size_t
+hexMismatch(const uint8_t *a, const uint8_t *b, size_t n)
+{
+    return kernels().mismatch(a, b, n);
+}
+
+// *****************************************************************************
+// Function     [ hexMatch ]
+// Description  [ ]
+// *****************************************************************************
+size_t
+hexMatch(const uint8_t *a, const uint8_t *b, size_t n)
+{
+    return kernels().match(a, b, n);
+}
+
+// *****************************************************************************
+// Function     [ clear ]
+// Description  [ ]
+// *****************************************************************************
+void
+hexDiffReport::clear()
+{
+    ranges.clear();
+    compared = 0;
+    bytes = 0;
+    cleared = 0;
+    set = 0;
+}
+
+// *****************************************************************************
+// Function     [ addRange ]
+// Description  [ Count the flipped bits of a differing run, eight bytes at a
+//                time, and add it to the report.
+//              ]
+// *****************************************************************************
+static void
+addRange(hexDiffReport &report, uint32_t address,
+         const uint8_t *expected, const uint8_t *actual, size_t n)
+{
+    size_t cleared = 0;
+    size_t set = 0;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t e, a;
+        std::memcpy(&e, expected + i, 8);
+        std::memcpy(&a, actual + i, 8);
+        cleared += hexBitCount(e & ~a);
+        set     += hexBitCount(~e & a);
+    }
+    for (; i < n; ++i) {
+        hexBitFlips f = hexClassify(expected[i], actual[i]);
+        cleared += hexBitCount(f.cleared);
+        set     += hexBitCount(f.set);
+    }
+
+    if (!report.ranges.empty() &&
+        report.ranges.back().address + report.ranges.back().size == address) {
+        hexDiffRange &r = report.ranges.back();
+        r.size    += (uint32_t) n;
+        r.cleared += (uint32_t) cleared;
+        r.set     += (uint32_t) set;
+    }
+    else {
+        hexDiffRange r = { address, (uint32_t) n, (uint32_t) cleared, (uint32_t) set };
+        report.ranges.push_back(r);
+    }
+    report.bytes   += n;
+    report.cleared += cleared;
+    report.set     += set;
+}
+
+// *****************************************************************************
+// Function     [ hexDiff ]
+// Description  [ Skip the equal stretches and measure the unequal ones ]
+// *****************************************************************************
+void
+hexDiff(const uint8_t *expected, const uint8_t *actual, size_t n,
+        uint32_t address, hexDiffReport &report)
+{
+    const diffKernels &k = kernels();
+    report.compared += n;
+    size_t i = 0;
+    while (i < n) {
+        i += k.mismatch(expected + i, actual + i, n - i);
+        if (i == n) {
+            break;
+        }
+        size_t run = k.match(expected + i, actual + i, n - i);
+        addRange(report, address + (uint32_t) i, expected + i, actual + i, run);
+        i += run;
+    }
+}
+
+// *****************************************************************************
+// Function     [ covers ]
+// Description  [ True if the image's buffer holds all of [lo, hi) ]
+// *****************************************************************************
+static bool
+covers(const hexImage &image, uint32_t lo, uint32_t hi)
+{
+    return !image.empty() && lo >= image.baseAddress() && hi <= image.endAddress();
+}
+
+// *****************************************************************************
+// Function     [ diffInterval ]
+// Description  [ Compare [lo, hi) of two images. The interval is cut where
+//                either image's buffer starts or ends, so each piece is
+//                either in the buffer (whose gaps already hold the fill) or
+//                wholly outside it and compared against the fill.
+//              ]
+// *****************************************************************************
+static void
+diffInterval(const hexImage &expected, const hexImage &actual,
+             uint32_t lo, uint32_t hi, hexDiffReport &report)
+{
+    // Each edge goes in in order, ahead of hi. Few enough not to need a sort.
+    uint32_t cuts[6] = { lo, hi };
+    size_t nCuts = 2;
+    const uint32_t edges[4] = { expected.baseAddress(), expected.endAddress(),
+                                actual.baseAddress(),   actual.endAddress() };
+    for (uint32_t e : edges) {
+        if (e > lo && e < hi) {
+            size_t c = nCuts++;
+            for (; cuts[c - 1] > e; --c) {
+                cuts[c] = cuts[c - 1];
+            }
+            cuts[c] = e;
+        }
+    }
+
+    uint8_t expectedFill[256];
+    uint8_t actualFill[256];
+    std::memset(expectedFill, expected.fill(), sizeof(expectedFill));
+    std::memset(actualFill, actual.fill(), sizeof(actualFill));
+
+    for (size_t c = 0; c + 1 < nCuts; ++c) {
+        uint32_t p = cuts[c];
+        uint32_t q = cuts[c + 1];
+        if (p == q) {
+            continue;
+        }
+        bool inExpected = covers(expected, p, q);
+        bool inActual   = covers(actual, p, q);
+        if (inExpected && inActual) {
+            hexDiff(expected.data() + (p - expected.baseAddress()),
+                    actual.data() + (p - actual.baseAddress()), q - p, p, report);
+            continue;
+        }
+        while (p < q) {
+            uint32_t n = std::min<uint32_t>(q - p, sizeof(expectedFill));
+            const uint8_t *e = inExpected ? expected.data() + (p - expected.baseAddress()) : expectedFill;
+            const uint8_t *a = inActual ? actual.data() + (p - actual.baseAddress()) : actualFill;
+            hexDiff(e, a, n, p, report);
+            p += n;
+        }
+    }
+}
+
+// *****************************************************************************
+// Function     [ hexDiff ]
+// Description  [ Walk the spans of both images together, comparing each
+//                stretch of their union.
+//              ]
+// *****************************************************************************
+hexDiffReport
+hexDiff(const hexImage &expected, const hexImage &actual)
+{
+    hexDiffReport report;
+    const hexSpanView expectedSpans = expected.spans();
+    const hexSpanView actualSpans = actual.spans();
+    hexSpanIterator e = expectedSpans.begin(), eEnd = expectedSpans.end();
+    hexSpanIterator a = actualSpans.begin(), aEnd = actualSpans.end();
+
+    while (e != eEnd || a != aEnd) {
+        uint32_t lo, hi;
+        if (a == aEnd || (e != eEnd && e->address <= a->address)) {
+            lo = e->address;
+            hi = lo + (uint32_t) e->size;
+            ++e;
+        }
+        else {
+            lo = a->address;
+            hi = lo + (uint32_t) a->size;
+            ++a;
+        }
+        // Take in whatever overlaps or abuts, from either side
+        for (;;) {
+            if (e != eEnd && e->address <= hi) {
+                hi = std::max(hi, e->address + (uint32_t) e->size);
+                ++e;
+            }
+            else if (a != aEnd && a->address <= hi) {
+                hi = std::max(hi, a->address + (uint32_t) a->size);
+                ++a;
+            }
+            else {
+                break;
+            }
+        }
+        diffInterval(expected, actual, lo, hi, report);
+    }
+    return report;
+}
+
+// *****************************************************************************
+// Function     [ hexDiffDump ]
+// Description  [ The image's gaps keep the image's own bytes, so they can't
+//                differ. With the read checked on the way in, a short dump
+//                is all that can leave bytes missing.
+//              ]
+// *****************************************************************************
+void
+hexDiffDump(const hexImage &image, const uint8_t *dump, size_t n,
+            std::vector<uint8_t> &device, std::vector<uint32_t> &unread,
+            hexDiffReport &report)
+{
+    device.assign(image.data(), image.data() + image.extent());
+    unread.clear();
+    const hexSpanView spans = image.spans();
+    size_t offset = 0;
+    for (auto iter = spans.begin(); iter != spans.end(); ++iter) {
+        const hexSpan &span = *iter;
+        uint8_t *d = device.data() + (span.address - image.baseAddress());
+        const size_t have = offset < n ? std::min(span.size, n - offset) : 0;
+        if (have > 0) {
+            std::memcpy(d, dump + offset, have);
+        }
+        for (size_t i = have; i < span.size; ++i) {
+            unread.push_back(span.address + (uint32_t) i);
+        }
+        offset += span.size;
+    }
+    hexDiff(image.data(), device.data(), device.size(), image.baseAddress(), report);
+}
@@ -0,0 +1,113 @@
+#ifndef HEXDIFF_H
+#define HEXDIFF_H
+
+// *****************************************************************************
+// File         [ hexDiff.h ]
+// Description  [ Comparison of an expected image against what was actually
+//                found, e.g. a device readback or a second file. Buffers
+//                are compared 16 or 32 bytes at a time and the differences
+//                come back as coalesced address ranges, with the flipped
+//                bits counted each way.
+//              ]
+// Author       [ Keith Sabine ]
+// *****************************************************************************
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "hexImage.h"
+
+// *****************************************************************************
+// Class        [ hexBitFlips ]
+// Description  [ How one byte differs from what was expected. On an EPROM
+//                an erased bit reads 1 and programming clears it, so bits
+//                that are set but should be clear may take another write,
+//                while bits that are clear but should be set need an erase.
+//              ]
+// *****************************************************************************
+struct hexBitFlips
+{
+    uint8_t                   cleared;      // 1 expected, 0 found
+    uint8_t                   set;          // 0 expected, 1 found
+};
+
+inline hexBitFlips
+hexClassify(uint8_t expected, uint8_t actual)
+{
+    hexBitFlips f;
+    f.cleared = (uint8_t) (expected & ~actual);
+    f.set     = (uint8_t) (~expected & actual);
+    return f;
+}
+
+// *****************************************************************************
+// Class        [ hexDiffRange ]
+// Description  [ A run of differing bytes, and the bits flipped over it ]
+// *****************************************************************************
+struct hexDiffRange
+{
+    uint32_t                  address;
+    uint32_t                  size;
+    uint32_t                  cleared;
+    uint32_t                  set;
+};
+
+// *****************************************************************************
+// Class        [ hexDiffReport ]
+// Description  [ Everything a comparison found. Ranges are in address order
+//                and never touch each other.
+//              ]
+// *****************************************************************************
+struct hexDiffReport
+{
+    std::vector<hexDiffRange> ranges;
+    size_t                    compared = 0;     // bytes looked at
+    size_t                    bytes = 0;        // bytes differing
+    size_t                    cleared = 0;      // bits, over all ranges
+    size_t                    set = 0;
+
+    bool                      identical() const { return ranges.empty(); }
+    void                      clear();
+};
+
+// Offset of the first byte where a and b differ, or n if they are equal.
+size_t                        hexMismatch(const uint8_t *a, const uint8_t *b, size_t n);
+
+// Offset of the first byte where a and b agree, or n if none do.
+size_t                        hexMatch(const uint8_t *a, const uint8_t *b, size_t n);
+
+// *****************************************************************************
+// Function     [ hexDiff ]
+// Description  [ Compare n bytes found against those expected, the first
+//                being at address, adding to the report. Ranges continue
+//                any the report already ends with.
+//              ]
+// *****************************************************************************
+void                          hexDiff(const uint8_t *expected, const uint8_t *actual, size_t n,
+                                      uint32_t address, hexDiffReport &report);
+
+// *****************************************************************************
+// Function     [ hexDiff ]
+// Description  [ Compare two images wherever either has data. Where only
+//                one has data the other reads as its fill.
+//              ]
+// *****************************************************************************
+hexDiffReport                 hexDiff(const hexImage &expected, const hexImage &actual);
+
+// *****************************************************************************
+// Function     [ hexDiffDump ]
+// Description  [ Compare a device's dump, n bytes from its offset 0, against
+//                the image written to it. A write sends the image's spans
+//                back to back from offset 0, so that is where they are
+//                looked for, and the image's addresses only name them.
+//                device is what the device holds, laid out as the image is
+//                from its base address, with the image's own bytes in its
+//                gaps. Bytes past the end of the dump are unread, by their
+//                image address, rather than diffs.
+//              ]
+// *****************************************************************************
+void                          hexDiffDump(const hexImage &image, const uint8_t *dump, size_t n,
+                                          std::vector<uint8_t> &device, std::vector<uint32_t> &unread,
+                                          hexDiffReport &report);
+
+#endif /* HEXDIFF_H */
@@ -0,0 +1,261 @@
+// *****************************************************************************
+// File         [ hexDigest.cpp ]
+// Description  [ Implementation of the CRC32 and SHA-256 routines ]
+// Author       [ Keith Sabine ]
+// *****************************************************************************
+
+#include "hexDigest.h"
+
+#include <cstring>
+
+// The reflected CRC32 polynomial
+static const uint32_t         crcPoly = 0xedb88320;
+
+// *****************************************************************************
+// Class        [ crcTables ]
+// Description  [ Slice by 8 tables: table[k][b] is the CRC of byte b
+//                followed by k zero bytes.
+//              ]
+// *****************************************************************************
+struct crcTables
+{
+    uint32_t                  table[8][256];
+    // x^(2^n) mod p, for combining
+    uint32_t                  x2n[32];
+
+    crcTables();
+};
+
+// *****************************************************************************
+// Function     [ multModP ]
+// Description  [ a * b modulo the CRC polynomial, both reflected ]
+// *****************************************************************************
+static uint32_t
+multModP(uint32_t a, uint32_t b)
+{
+    uint32_t m = 1u << 31;
+    uint32_t p = 0;
+    for (;;) {
+        if (a & m) {
+            p ^= b;
+            if ((a & (m - 1)) == 0) {
+                break;
+            }
+        }
+        m >>= 1;
+        b = (b & 1) ? (b >> 1) ^ crcPoly : b >> 1;
+    }
+    return p;
+}
+
+// *****************************************************************************
+// Function     [ constructor ]
+// Description  [ ]
+// *****************************************************************************
+crcTables::crcTables()
+{
+    for (uint32_t b = 0; b < 256; ++b) {
+        uint32_t c = b;
+        for (int32_t k = 0; k < 8; ++k) {
+            c = (c & 1) ? (c >> 1) ^ crcPoly : c >> 1;
+        }
+        table[0][b] = c;
+    }
+    for (uint32_t b = 0; b < 256; ++b) {
+        for (int32_t k = 1; k < 8; ++k) {
+            uint32_t c = table[k - 1][b];
+            table[k][b] = (c >> 8) ^ table[0][c & 0xff];
+        }
+    }
+
+    uint32_t p = 1u << 30;      // x^1
+    x2n[0] = p;
+    for (int32_t n = 1; n < 32; ++n) {
+        x2n[n] = p = multModP(p, p);
+    }
+}
+
+static const crcTables        s_Crc;
+
+// *****************************************************************************
+// Function     [ crc32Update ]
+// Description  [ Eight bytes per step through the tables, then the tail
+//                a byte at a time.
+//              ]
+// *****************************************************************************
+uint32_t
+crc32Update(uint32_t crc, const uint8_t *p, size_t n)
+{
+    const uint32_t (*t)[256] = s_Crc.table;
+    crc = ~crc;
+    while (n >= 8) {
+        uint32_t lo = crc ^ ((uint32_t) p[0] | ((uint32_t) p[1] << 8) |
+                             ((uint32_t) p[2] << 16) | ((uint32_t) p[3] << 24));
+        crc = t[7][lo & 0xff] ^ t[6][(lo >> 8) & 0xff] ^
+              t[5][(lo >> 16) & 0xff] ^ t[4][lo >> 24] ^
+              t[3][p[4]] ^ t[2][p[5]] ^ t[1][p[6]] ^ t[0][p[7]];
+        p += 8;
+        n -= 8;
+    }
+    while (n--) {
+        crc = (crc >> 8) ^ t[0][(crc ^ *p++) & 0xff];
+    }
+    return ~crc;
+}
+
+// *****************************************************************************
+// Function     [ crc32CombineOp ]
+// Description  [ x^(8 * lengthB) mod p ]
+// *****************************************************************************
+uint32_t
+crc32CombineOp(size_t lengthB)
+{
+    uint32_t p = 1u << 31;      // x^0
+    uint32_t k = 3;
+    while (lengthB) {
+        if (lengthB & 1) {
+            p = multModP(s_Crc.x2n[k & 31], p);
+        }
+        lengthB >>= 1;
+        k++;
+    }
+    return p;
+}
+
+// *****************************************************************************
+// Function     [ crc32CombineWith ]
+// Description  [ ]
+// *****************************************************************************
+uint32_t
+crc32CombineWith(uint32_t crcA, uint32_t crcB, uint32_t op)
+{
+    return multModP(op, crcA) ^ crcB;
+}
+
+// *****************************************************************************
+// Function     [ crc32Combine ]
+// Description  [ ]
+// *****************************************************************************
+uint32_t
+crc32Combine(uint32_t crcA, uint32_t crcB, size_t lengthB)
+{
+    return crc32CombineWith(crcA, crcB, crc32CombineOp(lengthB));
+}
+
+// SHA-256 round constants
+static const uint32_t         shaK[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static inline uint32_t
+rotr(uint32_t x, int32_t n)
+{
+    return (x >> n) | (x << (32 - n));
+}
+
+// *****************************************************************************
+// Function     [ constructor ]
+// Description  [ ]
+// *****************************************************************************
+sha256::sha256() :
+    m_State { 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+              0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 },
+    m_Used(0),
+    m_Length(0)
+{
+}
+
+// *****************************************************************************
+// Function     [ block ]
+// Description  [ Compress one 64 byte block into the state ]
+// *****************************************************************************
+void
+sha256::block(const uint8_t *p)
+{
+    uint32_t w[64];
+    for (int32_t i = 0; i < 16; ++i) {
+        w[i] = ((uint32_t) p[4 * i] << 24) | ((uint32_t) p[4 * i + 1] << 16) |
+               ((uint32_t) p[4 * i + 2] << 8) | p[4 * i + 3];
+    }
+    for (int32_t i = 16; i < 64; ++i) {
+        uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint32_t a = m_State[0], b = m_State[1], c = m_State[2], d = m_State[3];
+    uint32_t e = m_State[4], f = m_State[5], g = m_State[6], h = m_State[7];
+    for (int32_t i = 0; i < 64; ++i) {
+        uint32_t s1 = rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25);
+        uint32_t ch = (e & f) ^ (~e & g);
+        uint32_t t1 = h + s1 + ch + shaK[i] + w[i];
+        uint32_t s0 = rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22);
+        uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+        uint32_t t2 = s0 + maj;
+        h = g; g = f; f = e; e = d + t1;
+        d = c; c = b; b = a; a = t1 + t2;
+    }
+    m_State[0] += a; m_State[1] += b; m_State[2] += c; m_State[3] += d;
+    m_State[4] += e; m_State[5] += f; m_State[6] += g; m_State[7] += h;
+}
+
+// *****************************************************************************
+// Function     [ update ]
+// Description  [ ]
+// *****************************************************************************
+void
+sha256::update(const uint8_t *data, size_t n)
+{
+    m_Length += n;
+    if (m_Used > 0) {
+        size_t take = (64 - m_Used < n) ? 64 - m_Used : n;
+        std::memcpy(m_Buffer + m_Used, data, take);
+        m_Used += take;
+        data += take;
+        n -= take;
+        if (m_Used < 64) {
+            return;
+        }
+        block(m_Buffer);
+        m_Used = 0;
+    }
+    while (n >= 64) {
+        block(data);
+        data += 64;
+        n -= 64;
+    }
+    std::memcpy(m_Buffer, data, n);
+    m_Used = n;
+}
+
+// *****************************************************************************
+// Function     [ finish ]
+// Description  [ Pad with 0x80, zeros and the bit length, then give the
+//                state big endian.
+//              ]
+// *****************************************************************************
+void
+sha256::finish(uint8_t digest[digestSize])
+{
+    uint64_t bits = m_Length * 8;
+    uint8_t pad[72] = { 0x80 };
+    size_t padLength = (m_Used < 56) ? 56 - m_Used : 120 - m_Used;
+    for (int32_t i = 0; i < 8; ++i) {
+        pad[padLength + i] = (uint8_t) (bits >> (56 - 8 * i));
+    }
+    update(pad, padLength + 8);
+
+    for (int32_t i = 0; i < 8; ++i) {
+        digest[4 * i]     = (uint8_t) (m_State[i] >> 24);
+        digest[4 * i + 1] = (uint8_t) (m_State[i] >> 16);
+        digest[4 * i + 2] = (uint8_t) (m_State[i] >> 8);
+        digest[4 * i + 3] = (uint8_t) m_State[i];
+    }
+}
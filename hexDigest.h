@@ -0,0 +1,59 @@
+#ifndef HEXDIGEST_H
+#define HEXDIGEST_H
+
+// *****************************************************************************
+// File         [ hexDigest.h ]
+// Description  [ CRC32 and SHA-256 of image data. The CRC is the usual
+//                zlib/PNG one, done eight bytes at a time from tables, and
+//                CRCs of neighbouring blocks can be combined without going
+//                back to the data.
+//              ]
+// Author       [ Keith Sabine ]
+// *****************************************************************************
+
+#include <cstddef>
+#include <cstdint>
+
+// Continue a CRC32 (start from 0) over n more bytes
+uint32_t                      crc32Update(uint32_t crc, const uint8_t *data, size_t n);
+
+inline uint32_t
+crc32(const uint8_t *data, size_t n)
+{
+    return crc32Update(0, data, n);
+}
+
+// The CRC32 of A followed by B, given crc(A), crc(B) and the length of B
+uint32_t                      crc32Combine(uint32_t crcA, uint32_t crcB, size_t lengthB);
+
+// crc32Combine split in two, for combining many blocks of one length
+uint32_t                      crc32CombineOp(size_t lengthB);
+uint32_t                      crc32CombineWith(uint32_t crcA, uint32_t crcB, uint32_t op);
+
+// *****************************************************************************
+// Class        [ sha256 ]
+// Description  [ SHA-256 (FIPS 180-4), fed any number of times then
+//                finished once.
+//              ]
+// *****************************************************************************
+class sha256
+{
+public:
+    static const size_t       digestSize = 32;
+
+    sha256();
+    ~sha256() {}
+
+    void                      update(const uint8_t *data, size_t n);
+    void                      finish(uint8_t digest[digestSize]);
+
+private:
+    void                      block(const uint8_t *p);
+
+    uint32_t                  m_State[8];
+    uint8_t                   m_Buffer[64];
+    size_t                    m_Used;
+    uint64_t                  m_Length;
+};
+
+#endif /* HEXDIGEST_H */
@@ -5,365 +5,238 @@
 // *****************************************************************************
 
 #include "hexFile.h"
-#include "guiMainWindow.h"
 
 #include <QFile>
-#include <QtWidgets/QMessageBox>
+#include <algorithm>
+#include <cstring>
 
 // *****************************************************************************
-// Function     [ byteCount ]
-// Description  [ ]
-// *****************************************************************************
-uint8_t
-hexDataChunk::byteCount()
-{
-    return m_ByteCount;
-}
-
-// *****************************************************************************
-// Function     [ setByteCount ]
+// Function     [ clear ]
 // Description  [ ]
 // *****************************************************************************
- void
-hexDataChunk::setByteCount(uint8_t n)
+void
+hexFile::clear()
 {
-    m_ByteCount = n;
+    m_Image.clear();
+    m_Diagnostics.clear();
 }
 
 // *****************************************************************************
-// Function     [ recordType ]
-// Description  [ ]
+// Function     [ imageCrc32 ]
+// Description  [ The image is taken in blocks of 1 << hexImage::blockShift
+//                bytes on block boundaries, clipped to the image at each
+//                end. A block's CRC is reused while its version and extent
+//                are unchanged, and the block CRCs are combined into one.
+//              ]
 // *****************************************************************************
- uint8_t
-hexDataChunk::recordType() const
+uint32_t
+hexFile::imageCrc32() const
 {
-    return m_RecordType;
-}
+    if (m_Image.extent() == 0) {
+        return 0;
+    }
 
-// *****************************************************************************
-// Function     [ setRecordType ]
-// Description  [ ]
-// *****************************************************************************
- void
-hexDataChunk::setRecordType(uint8_t n)
-{
-    m_RecordType = n;
+    const uint32_t shift = hexImage::blockShift;
+    const uint32_t lo    = m_Image.baseAddress();
+    const uint32_t hi    = m_Image.endAddress();
+    const uint32_t first = lo >> shift;
+    const uint32_t last  = (hi - 1) >> shift;
+    const uint8_t *data  = m_Image.data();
+
+    // Line the cache up with the image's blocks, keeping what we can
+    std::vector<blockCrc> crcs(last - first + 1, blockCrc { 0, 0, 0, 0 });
+    for (size_t i = 0; i < m_Crcs.size(); ++i) {
+        uint32_t block = m_CrcFirst + (uint32_t) i;
+        if (block >= first && block <= last) {
+            crcs[block - first] = m_Crcs[i];
+        }
+    }
+    m_Crcs.swap(crcs);
+    m_CrcFirst = first;
+
+    // Most blocks are whole, so the combining step is worked out once
+    const uint32_t wholeOp = crc32CombineOp(size_t(1) << shift);
+    uint32_t crc = 0;
+    for (uint32_t block = first; block <= last; ++block) {
+        blockCrc &c = m_Crcs[block - first];
+        uint32_t blo = std::max(lo, block << shift);
+        uint32_t bhi = (block == last) ? hi : (block + 1) << shift;
+        uint64_t version = m_Image.blockVersion(block);
+        if (c.version != version || c.lo != blo || c.hi != bhi) {
+            c.version = version;
+            c.lo      = blo;
+            c.hi      = bhi;
+            c.crc     = crc32(data + (blo - lo), bhi - blo);
+        }
+        if (block == first) {
+            crc = c.crc;
+        }
+        else if (bhi - blo == (1u << shift)) {
+            crc = crc32CombineWith(crc, c.crc, wholeOp);
+        }
+        else {
+            crc = crc32Combine(crc, c.crc, bhi - blo);
+        }
+    }
+    return crc;
 }
 
 // *****************************************************************************
-// Function     [ address ]
-// Description  [ ]
+// Function     [ imageSha256 ]
+// Description  [ Recomputed only when the image has changed ]
 // *****************************************************************************
- uint16_t
-hexDataChunk::address() const
+void
+hexFile::imageSha256(uint8_t digest[sha256::digestSize]) const
 {
-    return m_Address;
+    if (m_ShaVersion != m_Image.version()) {
+        sha256 h;
+        h.update(m_Image.data(), m_Image.extent());
+        h.finish(m_Sha);
+        m_ShaVersion = m_Image.version();
+    }
+    std::memcpy(digest, m_Sha, sha256::digestSize);
 }
 
 // *****************************************************************************
-// Function     [ setAddress ]
-// Description  [ ]
+// Function     [ sniff ]
+// Description  [ Recognise the format of a file from its first few bytes.
+//                Returns nullptr if the file can't be opened.
+//              ]
 // *****************************************************************************
- void
-hexDataChunk::setAddress(uint16_t n)
+const hexFormat *
+hexFile::sniff(const QString& fileName)
 {
-    m_Address = n;
+    QFile fi(fileName);
+    if (!fi.open(QIODevice::ReadOnly)) {
+        return nullptr;
+    }
+    char head[hexSniffLength];
+    qint64 n = fi.read(head, sizeof(head));
+    return hexSniffFormat(head, (n > 0) ? (size_t) n : 0);
 }
 
 // *****************************************************************************
-// Function     [ checkSum ]
-// Description  [ ]
+// Function     [ read ]
+// Description  [ Read a file in the given format, or whichever format it
+//                looks like if that is nullptr. The file is memory mapped
+//                (or read in one go if it can't be) and decoded in place,
+//                rather than a line at a time. A binary file is placed at
+//                baseAddress. Returns false if the file can't be opened or
+//                has errors, which are then listed in diagnostics().
+//              ]
 // *****************************************************************************
- uint8_t
-hexDataChunk::checkSum() const
+bool
+hexFile::read(const QString& fileName, const hexFormat *format, uint32_t baseAddress)
 {
-    return m_Checksum;
-}
+    QFile fi(fileName);
+    if (!fi.open(QIODevice::ReadOnly)) {
+        return false;
+    }
 
-// *****************************************************************************
-// Function     [ setCheckSum ]
-// Description  [ ]
-// *****************************************************************************
- void
-hexDataChunk::setCheckSum(uint8_t n)
-{
-    m_Checksum = n;
-}
+    const qint64 length = fi.size();
+    uchar *map = (length > 0) ? fi.map(0, length) : nullptr;
+    QByteArray buffer;
+    const char *text = reinterpret_cast<const char *>(map);
+    if (map == nullptr) {
+        buffer = fi.readAll();
+        text = buffer.constData();
+    }
+    const size_t size = (map != nullptr) ? (size_t) length : (size_t) buffer.size();
 
-// *****************************************************************************
-// Function     [ data ]
-// Description  [ ]
-// *****************************************************************************
- std::vector<uint8_t> &
-hexDataChunk::data()
-{
-    return m_Data;
-}
+    if (format == nullptr) {
+        format = hexSniffFormat(text, size);
+    }
 
-// *****************************************************************************
-// Function     [ setData ]
-// Description  [ ]
-// *****************************************************************************
- void
-hexDataChunk::setData(const std::vector<uint8_t> &d)
-{
-    m_Data = d;
-}
+    hexLoadOptions options;
+    options.baseAddress = baseAddress;
+    options.threads     = m_ParseThreads;
 
-// *****************************************************************************
-// Function     [ setMainWindow ]
-// Description  [ ]
-// *****************************************************************************
-void
-hexFile::setMainWindow(guiMainWindow* win)
-{
-    m_MainWindow = win;
-}
+    clear();
+    bool ok = format->load(text, size, m_Image, &m_Diagnostics, options);
 
-// *****************************************************************************
-// Function     [ mainWindow ]
-// Description  [ ]
-// *****************************************************************************
-guiMainWindow*
-hexFile::mainWindow()
-{
-    return m_MainWindow;
+    if (map != nullptr) {
+        fi.unmap(map);
+    }
+    fi.close();
+    return ok;
 }
 
 // *****************************************************************************
-// Function     [ size ]
-// Description  [ Get the size of the hex file in bytes ]
+// Function     [ write ]
+// Description  [ Write the image to disk in the given format, Intel HEX if
+//                that is nullptr, laid out as saveOptions() says. Returns
+//                false if the file can't be written, or the image can't be
+//                expressed with those options.
+//              ]
 // *****************************************************************************
-size_t
-hexFile::size()
+bool
+hexFile::write(const QString& fileName, const hexFormat *format)
 {
-    size_t result=0;
-    for (auto iter = m_HexData.begin(); iter != m_HexData.end(); ++iter) {
-        hexDataChunk chunk = *iter;
-        result += chunk.byteCount();
-
+    if (format == nullptr) {
+        format = hexFormatFor(hexFormat::IntelHex);
     }
-    return result;
-}
 
-// *****************************************************************************
-// Function     [ hexData ]
-// Description  [ ]
-// *****************************************************************************
-std::vector<hexDataChunk> &
-hexFile::hexData()
-{
-    return m_HexData;
-}
+    // Format it all in memory, then write it in one go
+    std::string out;
+    if (!format->save(m_Image, out, m_SaveOptions)) {
+        return false;
+    }
 
-// *****************************************************************************
-// Function     [ addChunk ]
-// Description  [ ]
-// *****************************************************************************
-void
-hexFile::addChunk(const hexDataChunk &c)
-{
-    m_HexData.push_back(c);
+    QFile fi(fileName);
+    if (!fi.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    bool ok = fi.write(out.data(), (qint64) out.size()) == (qint64) out.size();
+    fi.close();
+    return ok;
 }
 
 // *****************************************************************************
-// Function     [ clear ]
-// Description  [ ]
+// Function     [ readHex ]
+// Description  [ Read an Intel HEX file ]
 // *****************************************************************************
-void
-hexFile::clear()
+bool
+hexFile::readHex(const QString& hexFileName)
 {
-    m_HexData.clear();
+    return read(hexFileName, hexFormatFor(hexFormat::IntelHex));
 }
 
 // *****************************************************************************
 // Function     [ readHex ]
-// Description  [ Read a hex file, setting up the data ]
+// Description  [ Read Intel HEX from an open device (a pipe, socket, process
+//                or serial port) as it arrives, up to the end of file
+//                record or until the device has nothing more to give.
+//              ]
 // *****************************************************************************
 bool
-hexFile::readHex(const QString& hexFileName)
-{
-    mainWindow()->clearText();
-    QFile fi(hexFileName);
-    if (fi.open(QIODevice::ReadOnly)) {
-
-        // Initialise some stuff
-        uint32_t lineNum = 0;
-        bool ok = true;
-        QString s;
-        m_HexData.clear();
-
-        while (!fi.atEnd()) {
-            hexDataChunk chunk;
-
-            // Read a line
-            QString line = fi.readLine();
-            // Append it to the msg area
-            mainWindow()->appendText(line.remove("\n"));
-
-            // Get the start character
-            int32_t index = line.indexOf(QChar(':'));
-            if (index < 0) {
-                QString message = QString("Not a valid HEX file at line %1").arg(lineNum);
-                QMessageBox::warning(nullptr, "Not a HEX file", message);
-                return false;
-            }
-
-            // The sum of all bytes following ':'
-            uint32_t checkSum = 0;
-
-            // Get byte count
-            s = line.sliced(++index, 2);
-            int8_t byteCount = s.toInt(&ok, 16);
-            if (ok) {
-                chunk.setByteCount(byteCount);
-                checkSum += byteCount;
-            }
-            else {
-                QString message = QString("Invalid byte count %s at line %1").arg(s).arg(lineNum);
-                QMessageBox::warning(nullptr, "Invalid byte count", message);
-                return false;
-            }
-            index += 2;
-
-            // Get the address
-            s = line.sliced(index, 2);
-            uint8_t hi = s.toInt(&ok, 16);
-            if (ok) {
-                checkSum += hi;
-                index += 2;
-            }
-            else {
-                QString message = QString("Invalid hi address %1 at line %2").arg(s).arg(lineNum);
-                QMessageBox::warning(nullptr, "Invalid address", message);
-                return false;
-            }
-            s = line.sliced(index, 2);
-            uint8_t lo = s.toInt(&ok, 16);
-            if (ok) {
-                checkSum += lo;
-                index += 2;
-                int16_t address = (hi << 8) + lo;
-                chunk.setAddress(address);
-            }
-            else {
-                QString message = QString("Invalid lo address %1 at line %2").arg(s).arg(lineNum);
-                QMessageBox::warning(nullptr, "Invalid address", message);
-                return false;
-            }
-
-
-            // Get the record type
-            s = line.sliced(index, 2);
-            int8_t recType = s.toInt(&ok, 16);
-            if (ok) {
-                if (recType == 1) {
-                    // this is an end of file
-                    fi.close();
-                    return true;
-                }
-                else if (recType == 0) {
-                    chunk.setRecordType(recType);
-                    checkSum += recType;
-                }
-                else {
-                    QString message = QString("Invalid record type %1 at line %2").arg(s).arg(lineNum);
-                    QMessageBox::warning(nullptr, "Invalid record type", message);
-                    return false;
-                }
-            }
-            else {
-                QString message = QString("Invalid record type %1 at line %2").arg(s).arg(lineNum);
-                QMessageBox::warning(nullptr, "Invalid record type", message);
-                return false;
-            }
-            index += 2;
-
-            // Get the bytes
-            std::vector<uint8_t> data;
-            for (int8_t i = 0; i < byteCount; ++i) {
-                s = line.sliced(index, 2);
-                int16_t val = s.toInt(&ok, 16);
-                if (ok) {
-                    data.push_back(val);
-                    checkSum += val;
-                }
-                else {
-                    QString message = QString("Invalid byte %s at line %1").arg(s).arg(lineNum);
-                    QMessageBox::warning(nullptr, "Invalid byte", message);
-                    return false;
-                }
-                index += 2;
-            }
-            chunk.setData(data);
-
-            // Compute the checksum, which is the two's complement of the lsb of the sum of all bytes.
-            uint8_t lsb = ~(checkSum & 0xff)+1;
-
-            // Get the checksum and compare, just in case
-            s = line.sliced(index, 2);
-            uint8_t cs = s.toInt(&ok, 16);
-            if (ok) {
-                if (cs != lsb) {
-                    QString message = QString("Invalid checksum at line %1").arg(lineNum);
-                    QMessageBox::warning(nullptr, "Invalid checksum", message);
-                    return false;
-                }
-                else {
-                    chunk.setCheckSum(cs);
-                }
-            }
-
-            // Add to the hex buffer
-            m_HexData.push_back(chunk);
-
-            // bump line number
-            lineNum++;
-
-        } // while not at end of file
-
+hexFile::readHex(QIODevice& device)
+{
+    // How long to wait for more from a pipe or socket
+    const int32_t timeout = 5000;
+
+    clear();
+    hexStreamParser parser(m_Image);
+    char buffer[64 * 1024];
+    while (!parser.done()) {
+        qint64 n = device.read(buffer, sizeof(buffer));
+        if (n > 0) {
+            parser.feed(buffer, (size_t) n);
+        }
+        else if (n < 0 || !device.isSequential() || !device.waitForReadyRead(timeout)) {
+            break;
+        }
     }
-    fi.close();
-    return true;
+    parser.finish();
+    m_Diagnostics = parser.diagnostics();
+    return parser.ok();
 }
 
 // *****************************************************************************
 // Function     [ writeHex ]
-// Description  [ Write the hexData buffer to disk ]
+// Description  [ Write the image to disk as Intel HEX ]
 // *****************************************************************************
 bool
 hexFile::writeHex(const QString& hexFileName)
 {
-    QFile fi(hexFileName);
-    if (fi.open(QIODevice::WriteOnly)) {
-        for (auto iter = m_HexData.begin(); iter != m_HexData.end(); ++iter) {
-            hexDataChunk chunk = *iter;
-            QString line, s;
-            // Start with identifier
-            line.append(QChar(':'));
-            // then the byte count
-            s = QString("%1").arg(chunk.byteCount(), 2, 16, QChar('0'));
-            line.append(s.toUpper());
-            // then the address
-            s = QString("%1").arg(chunk.address(), 4, 16, QChar('0'));
-            line.append(s.toUpper());
-            // then the record type
-            s = QString("%1").arg(chunk.recordType(), 2, 16, QChar('0'));
-            line.append(s.toUpper());
-            // then the data
-            for (int32_t i = 0; i < chunk.byteCount(); ++i) {
-                s = QString("%1").arg(chunk.data().at(i), 2, 16, QChar('0'));
-                line.append(s.toUpper());
-            }
-            // lastly the checksum and a newline
-            s = QString("%1\n").arg(chunk.checkSum(), 2, 16, QChar('0'));
-            line.append(s.toUpper());
-            fi.write(line.toLatin1());
-        }
-        // At the end, write a zero padded line with recType 1
-        QString line(":00000001FF\n");
-        fi.write(line.toLatin1());
-    }
-    fi.close();
-    return true;
+    return write(hexFileName, hexFormatFor(hexFormat::IntelHex));
 }
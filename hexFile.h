@@ -8,65 +8,74 @@
 // *****************************************************************************
 
 #include <QString>
-
-class guiMainWindow;
-
-// *****************************************************************************
-// Class        [ hexDataChunk ]
-// Description  [ A chunk of hex data ]
-// *****************************************************************************
-class hexDataChunk
-{
-public:
-    hexDataChunk():
-        m_ByteCount(0),
-        m_RecordType(0),
-        m_Address(0),
-        m_Checksum(0) {}
-    ~hexDataChunk() {}
-
-    uint8_t                   byteCount();
-    void                      setByteCount(uint8_t n);
-    uint8_t                   recordType() const;
-    void                      setRecordType(uint8_t n);
-    uint16_t                  address() const;
-    void                      setAddress(uint16_t n);
-    uint8_t                   checkSum()const;
-    void                      setCheckSum(uint8_t n);
-    std::vector<uint8_t>    & data();
-    void                      setData(const std::vector<uint8_t> &d);
-
-private:
-    uint8_t                   m_ByteCount;
-    uint8_t                   m_RecordType;
-    uint16_t                  m_Address;
-    uint8_t                   m_Checksum;
-    std::vector<uint8_t>      m_Data;
-};
-
+#include <QIODevice>
+#include "hexImage.h"
+#include "hexParser.h"
+#include "hexFormat.h"
+#include "hexDigest.h"
 
 // *****************************************************************************
 // Class        [ hexFile ]
-// Description  [ A file of hexDataChunks ]
+// Description  [ A HEX file, read into (or written from) a hexImage. The
+//                file can be in any of the hexFormats. This has no GUI
+//                dependencies; problems found by read are kept in
+//                diagnostics() for the caller to report.
+//              ]
 // *****************************************************************************
 class hexFile
 {
 public:
-    hexFile() {}
+    hexFile() : m_ParseThreads(0), m_CrcFirst(0), m_ShaVersion(0) {}
     ~hexFile() {}
 
+    static const hexFormat  * sniff(const QString& fileName);
+    bool                      read(const QString& fileName, const hexFormat *format = nullptr,
+                                   uint32_t baseAddress = 0);
+    bool                      write(const QString& fileName, const hexFormat *format = nullptr);
+
     bool                      readHex(const QString& hexFileName);
+    bool                      readHex(QIODevice& device);
     bool                      writeHex(const QString& hexFileName);
-    void                      setMainWindow(guiMainWindow* win);
-    guiMainWindow           * mainWindow();
-    size_t                    size();
-    std::vector<hexDataChunk> &hexData();
-    void                      addChunk(const hexDataChunk &c);
+    size_t                    size() const { return m_Image.size(); }
+    hexImage                & image() { return m_Image; }
+    const hexImage          & image() const { return m_Image; }
+    // The loaded data as address tagged runs, without copying
+    hexSpanView               spans() const { return m_Image.spans(); }
+    const std::vector<hexDiagnostic> &diagnostics() const { return m_Diagnostics; }
     void                      clear();
 
+    // Threads used to decode big files, 0 for one per core
+    void                      setParseThreads(uint32_t n) { m_ParseThreads = n; }
+    uint32_t                  parseThreads() const { return m_ParseThreads; }
+
+    // Digests of the image bytes from baseAddress() to endAddress(), gaps
+    // holding the fill value. Both are cached; the CRC is kept per block,
+    // so after an edit only the blocks that changed are read again.
+    uint32_t                  imageCrc32() const;
+    void                      imageSha256(uint8_t digest[sha256::digestSize]) const;
+
+    // Record length and address records used by write
+    void                      setSaveOptions(const hexSaveOptions &o) { m_SaveOptions = o; }
+    const hexSaveOptions    & saveOptions() const { return m_SaveOptions; }
+
 private:
-    std::vector<hexDataChunk> m_HexData;
-    guiMainWindow           * m_MainWindow;
+    hexImage                  m_Image;
+    std::vector<hexDiagnostic> m_Diagnostics;
+    uint32_t                  m_ParseThreads;
+    hexSaveOptions            m_SaveOptions;
+
+    // The CRC of one block of the image, as of a block version
+    struct blockCrc
+    {
+        uint64_t              version;
+        uint32_t              lo;
+        uint32_t              hi;
+        uint32_t              crc;
+    };
+    mutable std::vector<blockCrc> m_Crcs;
+    mutable uint32_t          m_CrcFirst;
+    mutable uint64_t          m_ShaVersion;
+    mutable uint8_t           m_Sha[sha256::digestSize];
 };
 
 #endif /* HEXFILE_H */
@@ -0,0 +1,752 @@
+// *****************************************************************************
+// File         [ hexFormat.cpp ]
+// Description  [ Implementation of the hexFormat loaders and savers ]
+// Author       [ Keith Sabine ]
+// *****************************************************************************
+
+#include "hexFormat.h"
+#include "hexCodec.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+
+// *****************************************************************************
+// Function     [ isBlank ]
+// Description  [ ]
+// *****************************************************************************
+static inline bool
+isBlank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+// *****************************************************************************
+// Class        [ lineReader ]
+// Description  [ Steps through a buffer a line at a time, giving each line
+//                with its surrounding white space trimmed.
+//              ]
+// *****************************************************************************
+struct lineReader
+{
+    const char              * p;
+    const char              * end;
+    uint32_t                  number = 0;
+
+    lineReader(const char *text, size_t length) : p(text), end(text + length) {}
+
+    // Sets [b, e) to the next line, and line to where it starts
+    bool next(const char *&line, const char *&b, const char *&e)
+    {
+        if (p >= end) {
+            return false;
+        }
+        const char *eol = (const char *) std::memchr(p, '\n', end - p);
+        if (eol == nullptr) {
+            eol = end;
+        }
+        line = b = p;
+        e = eol;
+        p = (eol < end) ? eol + 1 : end;
+        number++;
+
+        while (b < e && isBlank(*b)) {
+            ++b;
+        }
+        while (e > b && isBlank(e[-1])) {
+            --e;
+        }
+        return true;
+    }
+};
+
+// *****************************************************************************
+// Function     [ skipBlanks ]
+// Description  [ The first non blank character of [head, head+n) ]
+// *****************************************************************************
+static const char *
+skipBlanks(const char *head, size_t n)
+{
+    const char *end = head + n;
+    while (head < end && isBlank(*head)) {
+        ++head;
+    }
+    return head;
+}
+
+// *****************************************************************************
+// Function     [ isHexDigit ]
+// Description  [ ]
+// *****************************************************************************
+static inline bool
+isHexDigit(char c)
+{
+    return g_HexTables.nibble[(uint8_t) c] < 16;
+}
+
+// *****************************************************************************
+// Function     [ writeImage ]
+// Description  [ Write a decoded run into the image, noting overlaps and
+//                addresses the image can't hold.
+//              ]
+// *****************************************************************************
+static bool
+writeImage(hexImage &image, uint32_t address, const uint8_t *data, size_t n,
+           std::vector<hexDiagnostic> &found, uint32_t line, uint32_t column)
+{
+    hexDiagnostic d;
+    d.line   = line;
+    d.column = column;
+    if (image.overlaps(address, n)) {
+        d.kind = hexDiagnostic::Overlap;
+        found.push_back(d);
+    }
+    if (!image.write(address, data, n)) {
+        d.kind = hexDiagnostic::AddressRange;
+        found.push_back(d);
+        return false;
+    }
+    return true;
+}
+
+// *****************************************************************************
+// Function     [ appendHex ]
+// Description  [ Append n bytes as upper case hex ]
+// *****************************************************************************
+static void
+appendHex(std::string &out, const uint8_t *data, size_t n)
+{
+    size_t at = out.size();
+    out.resize(at + 2 * n);
+    hexEncode(data, n, &out[at], true);
+}
+
+// *****************************************************************************
+// Class        [ intelHexFormat ]
+// Description  [ Intel HEX, decoded by hexParse ]
+// *****************************************************************************
+class intelHexFormat : public hexFormat
+{
+public:
+    Kind                      kind() const override { return IntelHex; }
+    const char              * name() const override { return "Intel HEX"; }
+    const char              * patterns() const override { return "*.hex *.ihx *.ihex"; }
+
+    bool sniff(const char *head, size_t n) const override
+    {
+        const char *p = skipBlanks(head, n);
+        return p + 2 <= head + n && p[0] == ':' && isHexDigit(p[1]);
+    }
+
+    bool load(const char *text, size_t length, hexImage &image,
+              std::vector<hexDiagnostic> *diagnostics,
+              const hexLoadOptions &options) const override
+    {
+        return hexParse(text, length, image, diagnostics, options.threads);
+    }
+
+    bool save(const hexImage &image, std::string &out,
+              const hexSaveOptions &options) const override;
+
+private:
+    template <typename Fn>
+    static bool               forEachRecord(const hexImage &image, const hexSaveOptions &options, Fn fn);
+    static char             * formatRecord(char *p, uint8_t recType, uint16_t address,
+                                           const uint8_t *data, uint8_t byteCount);
+};
+
+// *****************************************************************************
+// Function     [ intelHexFormat::forEachRecord ]
+// Description  [ Call fn(recType, address, data, byteCount) for each record
+//                the image needs, end of file included. Data records are
+//                options.recordLength long and never cross a 64k boundary,
+//                and an 02 or 04 record is issued whenever the upper part
+//                of the address changes, so hexParse gives back the same
+//                image. A start address, if the image has one, is written
+//                just before the end. Returns false if the image needs
+//                more address than the options allow.
+//              ]
+// *****************************************************************************
+template <typename Fn>
+bool
+intelHexFormat::forEachRecord(const hexImage &image, const hexSaveOptions &options, Fn fn)
+{
+    const size_t blocksize = std::max<size_t>(1, std::min<size_t>(options.recordLength, 255));
+
+    if ((options.addressRecords == hexSaveOptions::None    && image.endAddress() > 0x10000) ||
+        (options.addressRecords == hexSaveOptions::Segment && image.endAddress() > 0x100000)) {
+        return false;
+    }
+
+    uint32_t upper = 0;
+    const hexSpanView spans = image.spans();
+    for (auto iter = spans.begin(); iter != spans.end(); ++iter) {
+        const hexSpan &span = *iter;
+        size_t offset = 0;
+        while (offset < span.size) {
+            uint32_t address = span.address + (uint32_t) offset;
+            size_t toBoundary = 0x10000 - (address & 0xffff);
+            uint8_t byteCount = (uint8_t) std::min({ blocksize, span.size - offset, toBoundary });
+
+            if ((address >> 16) != upper) {
+                upper = address >> 16;
+                // A segment is in 16 byte paragraphs
+                uint32_t value = (options.addressRecords == hexSaveOptions::Segment) ? (upper << 12) : upper;
+                uint8_t ext[2] = { (uint8_t) (value >> 8), (uint8_t) value };
+                fn((options.addressRecords == hexSaveOptions::Segment) ? 2 : 4, 0, ext, 2);
+            }
+            fn(0, (uint16_t) address, span.data + offset, byteCount);
+            offset += byteCount;
+        }
+    }
+
+    const hexStartAddress &start = image.startAddress();
+    if (start.kind != hexStartAddress::None) {
+        uint8_t value[4] = { (uint8_t) (start.value >> 24), (uint8_t) (start.value >> 16),
+                             (uint8_t) (start.value >> 8),  (uint8_t) start.value };
+        fn((start.kind == hexStartAddress::Segment) ? 3 : 5, 0, value, 4);
+    }
+
+    // At the end, a zero padded line with recType 1
+    fn(1, 0, nullptr, 0);
+    return true;
+}
+
+// *****************************************************************************
+// Function     [ intelHexFormat::formatRecord ]
+// Description  [ Format one record at p: the ':' identifier, then byte
+//                count, address, type, data and checksum as upper case hex,
+//                and a newline. Returns the end of what was written.
+//              ]
+// *****************************************************************************
+char *
+intelHexFormat::formatRecord(char *p, uint8_t recType, uint16_t address,
+                             const uint8_t *data, uint8_t byteCount)
+{
+    // The checksum is the two's complement of the lsb of the sum of all bytes.
+    uint32_t checkSum = byteCount + (address >> 8) + (address & 0xff) + recType;
+    for (int32_t i = 0; i < byteCount; ++i) {
+        checkSum += data[i];
+    }
+
+    *p++ = ':';
+    hexEncodeByte(byteCount, p, true);
+    hexEncodeByte((uint8_t) (address >> 8), p + 2, true);
+    hexEncodeByte((uint8_t) address, p + 4, true);
+    hexEncodeByte(recType, p + 6, true);
+    p += 8;
+    hexEncode(data, byteCount, p, true);
+    p += 2 * byteCount;
+    hexEncodeByte((uint8_t) (~(checkSum & 0xff) + 1), p, true);
+    p[2] = '\n';
+    return p + 3;
+}
+
+// *****************************************************************************
+// Function     [ intelHexFormat::save ]
+// Description  [ Size the output exactly, then format every record into it
+//                with no further allocation.
+//              ]
+// *****************************************************************************
+bool
+intelHexFormat::save(const hexImage &image, std::string &out,
+                     const hexSaveOptions &options) const
+{
+    // Each record is ':', 2 * (5 + data) characters and '\n'
+    size_t length = 0;
+    bool ok = forEachRecord(image, options, [&](uint8_t, uint16_t, const uint8_t *, uint8_t byteCount) {
+        length += 12 + 2 * (size_t) byteCount;
+    });
+    if (!ok) {
+        return false;
+    }
+
+    size_t at = out.size();
+    out.resize(at + length);
+    char *p = &out[at];
+    forEachRecord(image, options, [&](uint8_t recType, uint16_t address, const uint8_t *data, uint8_t byteCount) {
+        p = formatRecord(p, recType, address, data, byteCount);
+    });
+    return true;
+}
+
+// *****************************************************************************
+// Class        [ sRecordFormat ]
+// Description  [ Motorola S-records. S1, S2 and S3 carry data with 16, 24
+//                and 32 bit addresses; S7, S8 and S9 end the file with a
+//                start address. S0 headers and S5/S6 counts are checked
+//                but otherwise ignored.
+//              ]
+// *****************************************************************************
+class sRecordFormat : public hexFormat
+{
+public:
+    Kind                      kind() const override { return SRecord; }
+    const char              * name() const override { return "Motorola S-record"; }
+    const char              * patterns() const override { return "*.s19 *.s28 *.s37 *.srec *.mot"; }
+
+    bool sniff(const char *head, size_t n) const override
+    {
+        const char *p = skipBlanks(head, n);
+        return p + 4 <= head + n && p[0] == 'S' && p[1] >= '0' && p[1] <= '9' &&
+               isHexDigit(p[2]) && isHexDigit(p[3]);
+    }
+
+    bool load(const char *text, size_t length, hexImage &image,
+              std::vector<hexDiagnostic> *diagnostics,
+              const hexLoadOptions &options) const override;
+    bool save(const hexImage &image, std::string &out,
+              const hexSaveOptions &options) const override;
+
+private:
+    static void               appendRecord(std::string &out, int32_t type, uint32_t address,
+                                           const uint8_t *data, size_t n);
+};
+
+// Address bytes for each record type; S4 is reserved
+static const int32_t          sRecordAddressBytes[10] = { 2, 2, 3, 4, 0, 2, 3, 4, 3, 2 };
+
+// *****************************************************************************
+// Function     [ sRecordFormat::load ]
+// Description  [ ]
+// *****************************************************************************
+bool
+sRecordFormat::load(const char *text, size_t length, hexImage &image,
+                    std::vector<hexDiagnostic> *diagnostics,
+                    const hexLoadOptions &) const
+{
+    std::vector<hexDiagnostic> found;
+    lineReader lines(text, length);
+    const char *line, *b, *e;
+
+    while (lines.next(line, b, e)) {
+        auto report = [&](hexDiagnostic::Kind kind, const char *c) {
+            hexDiagnostic d;
+            d.line   = lines.number;
+            d.column = (uint32_t) (c - line) + 1;
+            d.kind   = kind;
+            found.push_back(d);
+        };
+        if (b == e) {
+            continue;
+        }
+
+        if (*b != 'S') {
+            report(hexDiagnostic::NoStartCode, b);
+            continue;
+        }
+        if (e - b < 2 || b[1] < '0' || b[1] > '9' || b[1] == '4') {
+            report(hexDiagnostic::BadRecordType, b + 1);
+            continue;
+        }
+        int32_t type = b[1] - '0';
+        b += 2;
+
+        // The count covers address, data and checksum
+        size_t chars = e - b;
+        uint8_t byteCount = 0;
+        int32_t addressBytes = sRecordAddressBytes[type];
+        if (chars < 2 || !hexDecodePair(b, byteCount) || byteCount < addressBytes + 1) {
+            report(hexDiagnostic::BadByteCount, b);
+            continue;
+        }
+        if (chars != 2 * (1 + (size_t) byteCount)) {
+            report(hexDiagnostic::BadLength, e);
+            continue;
+        }
+
+        uint8_t record[255];
+        const char *s = b + 2;
+        if (!hexDecode(s, byteCount, record)) {
+            uint8_t d = 0;
+            while (hexDecodePair(s, d)) {
+                s += 2;
+            }
+            report(hexDiagnostic::BadData, s);
+            continue;
+        }
+
+        // The checksum is the ones' complement of the lsb of the sum of
+        // the count, address and data.
+        uint32_t checkSum = byteCount;
+        for (int32_t i = 0; i < byteCount - 1; ++i) {
+            checkSum += record[i];
+        }
+        if (((checkSum + record[byteCount - 1]) & 0xff) != 0xff) {
+            report(hexDiagnostic::BadChecksum, b + 2 * byteCount);
+            continue;
+        }
+
+        uint32_t address = 0;
+        for (int32_t i = 0; i < addressBytes; ++i) {
+            address = (address << 8) | record[i];
+        }
+
+        if (type >= 1 && type <= 3) {
+            size_t n = byteCount - addressBytes - 1;
+            writeImage(image, address, record + addressBytes, n, found,
+                       lines.number, (uint32_t) (b + 2 - line) + 1);
+        }
+        else if (type >= 7) {
+            // A zero start address is what tools write when there is none
+            if (address != 0) {
+                hexStartAddress start;
+                start.kind  = hexStartAddress::Linear;
+                start.value = address;
+                image.setStartAddress(start);
+            }
+            break;
+        }
+    }
+
+    bool ok = found.empty();
+    if (diagnostics) {
+        diagnostics->insert(diagnostics->end(), found.begin(), found.end());
+    }
+    return ok;
+}
+
+// *****************************************************************************
+// Function     [ sRecordFormat::appendRecord ]
+// Description  [ ]
+// *****************************************************************************
+void
+sRecordFormat::appendRecord(std::string &out, int32_t type, uint32_t address,
+                            const uint8_t *data, size_t n)
+{
+    int32_t addressBytes = sRecordAddressBytes[type];
+    uint8_t record[1 + 4 + 255];
+    size_t count = addressBytes + n + 1;
+    record[0] = (uint8_t) count;
+    for (int32_t i = 0; i < addressBytes; ++i) {
+        record[1 + i] = (uint8_t) (address >> (8 * (addressBytes - 1 - i)));
+    }
+    std::copy(data, data + n, record + 1 + addressBytes);
+
+    uint32_t checkSum = 0;
+    for (size_t i = 0; i < count; ++i) {
+        checkSum += record[i];
+    }
+    record[count] = (uint8_t) ~checkSum;
+
+    out.push_back('S');
+    out.push_back((char) ('0' + type));
+    appendHex(out, record, count + 1);
+    out.push_back('\n');
+}
+
+// *****************************************************************************
+// Function     [ sRecordFormat::save ]
+// Description  [ Uses the smallest address size that covers the image and
+//                its entry point, which may lie beyond the data
+//              ]
+// *****************************************************************************
+bool
+sRecordFormat::save(const hexImage &image, std::string &out,
+                    const hexSaveOptions &options) const
+{
+    const hexStartAddress &start = image.startAddress();
+    uint32_t entry = start.value;
+    if (start.kind == hexStartAddress::Segment) {
+        entry = ((start.value >> 16) << 4) + (start.value & 0xffff);
+    }
+
+    const uint64_t reach = std::max<uint64_t>(image.endAddress(), (uint64_t) entry + 1);
+    int32_t type = 1;
+    if (reach > 0x1000000) {
+        type = 3;
+    }
+    else if (reach > 0x10000) {
+        type = 2;
+    }
+
+    // The count byte covers address and checksum too
+    const size_t maxData = 255 - sRecordAddressBytes[type] - 1;
+    const size_t blocksize = std::max<size_t>(1, std::min<size_t>(options.recordLength, maxData));
+
+    // An empty header
+    appendRecord(out, 0, 0, nullptr, 0);
+
+    uint32_t records = 0;
+    const hexSpanView spans = image.spans();
+    for (auto iter = spans.begin(); iter != spans.end(); ++iter) {
+        const hexSpan &span = *iter;
+        for (size_t offset = 0; offset < span.size; offset += blocksize) {
+            size_t n = std::min(blocksize, span.size - offset);
+            appendRecord(out, type, span.address + (uint32_t) offset, span.data + offset, n);
+            records++;
+        }
+    }
+
+    // The record count, then the start address to end
+    if (records <= 0xffff) {
+        appendRecord(out, 5, records, nullptr, 0);
+    }
+    else if (records <= 0xffffff) {
+        appendRecord(out, 6, records, nullptr, 0);
+    }
+    appendRecord(out, 10 - type, entry, nullptr, 0);
+    return true;
+}
+
+// *****************************************************************************
+// Class        [ tiTxtFormat ]
+// Description  [ TI-TXT, as used for MSP430 parts: '@addr' lines set the
+//                address, then lines of space separated hex bytes, and 'q'
+//                ends the file.
+//              ]
+// *****************************************************************************
+class tiTxtFormat : public hexFormat
+{
+public:
+    Kind                      kind() const override { return TiTxt; }
+    const char              * name() const override { return "TI-TXT"; }
+    const char              * patterns() const override { return "*.txt"; }
+
+    bool sniff(const char *head, size_t n) const override
+    {
+        const char *p = skipBlanks(head, n);
+        return p + 2 <= head + n && p[0] == '@' && isHexDigit(p[1]);
+    }
+
+    bool load(const char *text, size_t length, hexImage &image,
+              std::vector<hexDiagnostic> *diagnostics,
+              const hexLoadOptions &options) const override;
+    bool save(const hexImage &image, std::string &out,
+              const hexSaveOptions &options) const override;
+};
+
+// *****************************************************************************
+// Function     [ tiTxtFormat::load ]
+// Description  [ ]
+// *****************************************************************************
+bool
+tiTxtFormat::load(const char *text, size_t length, hexImage &image,
+                  std::vector<hexDiagnostic> *diagnostics,
+                  const hexLoadOptions &) const
+{
+    std::vector<hexDiagnostic> found;
+    std::vector<uint8_t> bytes;
+    lineReader lines(text, length);
+    const char *line, *b, *e;
+    uint32_t address = 0;
+    bool haveAddress = false;
+
+    while (lines.next(line, b, e)) {
+        auto report = [&](hexDiagnostic::Kind kind, const char *c) {
+            hexDiagnostic d;
+            d.line   = lines.number;
+            d.column = (uint32_t) (c - line) + 1;
+            d.kind   = kind;
+            found.push_back(d);
+        };
+        if (b == e) {
+            continue;
+        }
+        if (*b == 'q' || *b == 'Q') {
+            break;
+        }
+
+        if (*b == '@') {
+            const char *s = b + 1;
+            uint64_t value = 0;
+            while (s < e && isHexDigit(*s) && value <= UINT32_MAX) {
+                value = (value << 4) | g_HexTables.nibble[(uint8_t) *s++];
+            }
+            if (s == b + 1 || s != e || value > UINT32_MAX) {
+                report(hexDiagnostic::BadAddress, b + 1);
+                haveAddress = false;
+                continue;
+            }
+            address = (uint32_t) value;
+            haveAddress = true;
+            continue;
+        }
+
+        if (!haveAddress) {
+            report(hexDiagnostic::BadAddress, b);
+            continue;
+        }
+
+        // Each byte is two hex digits, separated by white space
+        bytes.clear();
+        const char *s = b;
+        bool good = true;
+        while (s < e) {
+            uint8_t d = 0;
+            if (e - s < 2 || !hexDecodePair(s, d) || (e - s > 2 && !isBlank(s[2]))) {
+                report(hexDiagnostic::BadData, s);
+                good = false;
+                break;
+            }
+            bytes.push_back(d);
+            s += 2;
+            while (s < e && isBlank(*s)) {
+                ++s;
+            }
+        }
+        if (good) {
+            writeImage(image, address, bytes.data(), bytes.size(), found,
+                       lines.number, (uint32_t) (b - line) + 1);
+            address += (uint32_t) bytes.size();
+        }
+    }
+
+    bool ok = found.empty();
+    if (diagnostics) {
+        diagnostics->insert(diagnostics->end(), found.begin(), found.end());
+    }
+    return ok;
+}
+
+// *****************************************************************************
+// Function     [ tiTxtFormat::save ]
+// Description  [ An '@' line per span, then recordLength bytes to a line ]
+// *****************************************************************************
+bool
+tiTxtFormat::save(const hexImage &image, std::string &out,
+                  const hexSaveOptions &options) const
+{
+    const size_t blocksize = std::max<uint32_t>(1, options.recordLength);
+    const hexSpanView spans = image.spans();
+    for (auto iter = spans.begin(); iter != spans.end(); ++iter) {
+        const hexSpan &span = *iter;
+        char address[16];
+        int32_t n = std::snprintf(address, sizeof(address), "@%04X\n", span.address);
+        out.append(address, n);
+        for (size_t offset = 0; offset < span.size; offset += blocksize) {
+            size_t count = std::min(blocksize, span.size - offset);
+            for (size_t i = 0; i < count; ++i) {
+                char pair[3] = { 0, 0, ' ' };
+                hexEncodeByte(span.data[offset + i], pair, true);
+                out.append(pair, (i + 1 < count) ? 3 : 2);
+            }
+            out.push_back('\n');
+        }
+    }
+    out.append("q\n");
+    return true;
+}
+
+// *****************************************************************************
+// Class        [ binaryFormat ]
+// Description  [ Raw bytes, placed at options.baseAddress. Saving writes
+//                everything from the lowest to the highest address, with
+//                gaps holding the fill value.
+//              ]
+// *****************************************************************************
+class binaryFormat : public hexFormat
+{
+public:
+    Kind                      kind() const override { return Binary; }
+    const char              * name() const override { return "Binary"; }
+    const char              * patterns() const override { return "*.bin *.rom"; }
+
+    // Binary is what's left when nothing else claims a file
+    bool                      sniff(const char *, size_t) const override { return true; }
+
+    bool load(const char *text, size_t length, hexImage &image,
+              std::vector<hexDiagnostic> *diagnostics,
+              const hexLoadOptions &options) const override
+    {
+        if (length == 0) {
+            return true;
+        }
+        if (image.write(options.baseAddress, reinterpret_cast<const uint8_t *>(text), length)) {
+            return true;
+        }
+        if (diagnostics) {
+            hexDiagnostic d;
+            d.line   = 1;
+            d.column = 1;
+            d.kind   = hexDiagnostic::AddressRange;
+            diagnostics->push_back(d);
+        }
+        return false;
+    }
+
+    bool save(const hexImage &image, std::string &out, const hexSaveOptions &) const override
+    {
+        out.append(reinterpret_cast<const char *>(image.data()), image.extent());
+        return true;
+    }
+};
+
+// *****************************************************************************
+// Function     [ hexFormats ]
+// Description  [ ]
+// *****************************************************************************
+const std::vector<const hexFormat *> &
+hexFormats()
+{
+    static const intelHexFormat intelHex;
+    static const sRecordFormat  sRecord;
+    static const tiTxtFormat    tiTxt;
+    static const binaryFormat   binary;
+    static const std::vector<const hexFormat *> formats = { &intelHex, &sRecord, &tiTxt, &binary };
+    return formats;
+}
+
+// *****************************************************************************
+// Function     [ hexFormatFor ]
+// Description  [ ]
+// *****************************************************************************
+const hexFormat *
+hexFormatFor(hexFormat::Kind kind)
+{
+    const std::vector<const hexFormat *> &formats = hexFormats();
+    for (auto iter = formats.begin(); iter != formats.end(); ++iter) {
+        if ((*iter)->kind() == kind) {
+            return *iter;
+        }
+    }
+    return nullptr;
+}
+
+// *****************************************************************************
+// Function     [ hexFormatForSuffix ]
+// Description  [ Match "s19" against "*.s19 *.s28 ...", ignoring case ]
+// *****************************************************************************
+const hexFormat *
+hexFormatForSuffix(const char *suffix)
+{
+    const size_t n = std::strlen(suffix);
+    if (n == 0) {
+        return nullptr;
+    }
+    const std::vector<const hexFormat *> &formats = hexFormats();
+    for (auto iter = formats.begin(); iter != formats.end(); ++iter) {
+        const char *p = (*iter)->patterns();
+        while ((p = std::strstr(p, "*.")) != nullptr) {
+            p += 2;
+            size_t len = std::strcspn(p, " ");
+            bool same = (len == n);
+            for (size_t i = 0; same && i < n; ++i) {
+                same = (std::tolower((uint8_t) p[i]) == std::tolower((uint8_t) suffix[i]));
+            }
+            if (same) {
+                return *iter;
+            }
+            p += len;
+        }
+    }
+    return nullptr;
+}
+
+// *****************************************************************************
+// Function     [ hexSniffFormat ]
+// Description  [ ]
+// *****************************************************************************
+const hexFormat *
+hexSniffFormat(const char *head, size_t n)
+{
+    n = std::min(n, hexSniffLength);
+    const std::vector<const hexFormat *> &formats = hexFormats();
+    for (auto iter = formats.begin(); iter != formats.end(); ++iter) {
+        if ((*iter)->sniff(head, n)) {
+            return *iter;
+        }
+    }
+    return hexFormatFor(hexFormat::Binary);
+}
@@ -0,0 +1,107 @@
+#ifndef HEXFORMAT_H
+#define HEXFORMAT_H
+
+// *****************************************************************************
+// File         [ hexFormat.h ]
+// Description  [ Loaders and savers for the file formats a hexImage can be
+//                read from or written to: Intel HEX, Motorola S-records,
+//                TI-TXT and raw binary. Like hexParser, these work on byte
+//                buffers and don't touch the GUI.
+//              ]
+// Author       [ Keith Sabine ]
+// *****************************************************************************
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "hexImage.h"
+#include "hexParser.h"
+
+// The most a format will look at to recognise a file
+const size_t                  hexSniffLength = 64;
+
+// *****************************************************************************
+// Class        [ hexLoadOptions ]
+// Description  [ Settings a loader may need beyond the file contents ]
+// *****************************************************************************
+struct hexLoadOptions
+{
+    // Where a raw binary file starts in the image
+    uint32_t                  baseAddress = 0;
+    // Threads for the Intel HEX parser, 0 for one per core
+    uint32_t                  threads = 1;
+};
+
+// *****************************************************************************
+// Class        [ hexSaveOptions ]
+// Description  [ How a saver lays out its records ]
+// *****************************************************************************
+struct hexSaveOptions
+{
+    // How Intel HEX reaches data above 64k
+    enum AddressRecords
+    {
+        Linear,                  // 04 records, as needed
+        Segment,                 // 02 records, for images up to 1MB
+        None                     // 16 bit addresses only
+    };
+
+    // Data bytes per record (or line for TI-TXT), up to 255
+    uint32_t                  recordLength = 16;
+    AddressRecords            addressRecords = Linear;
+};
+
+// *****************************************************************************
+// Class        [ hexFormat ]
+// Description  [ One file format. load() decodes a whole file buffer (which
+//                may be memory mapped) straight into the image, reporting
+//                problems as hexDiagnostics. save() appends the image, in
+//                this format, to out; it returns false if the image can't
+//                be expressed with the given options.
+//              ]
+// *****************************************************************************
+class hexFormat
+{
+public:
+    enum Kind
+    {
+        IntelHex,
+        SRecord,
+        TiTxt,
+        Binary
+    };
+
+    virtual ~hexFormat() {}
+
+    virtual Kind              kind() const = 0;
+    // e.g. "Intel HEX"
+    virtual const char      * name() const = 0;
+    // File dialog patterns, e.g. "*.hex *.ihx"
+    virtual const char      * patterns() const = 0;
+    // True if the first bytes of a file look like this format
+    virtual bool              sniff(const char *head, size_t n) const = 0;
+    virtual bool              load(const char *text, size_t length, hexImage &image,
+                                   std::vector<hexDiagnostic> *diagnostics,
+                                   const hexLoadOptions &options) const = 0;
+    virtual bool              save(const hexImage &image, std::string &out,
+                                   const hexSaveOptions &options) const = 0;
+};
+
+// All the formats, Intel HEX first
+const std::vector<const hexFormat *> & hexFormats();
+
+const hexFormat             * hexFormatFor(hexFormat::Kind kind);
+
+// The format whose patterns include this file suffix (no dot), or nullptr
+const hexFormat             * hexFormatForSuffix(const char *suffix);
+
+// *****************************************************************************
+// Function     [ hexSniffFormat ]
+// Description  [ Recognise a file from at most hexSniffLength bytes of its
+//                start. Anything not claimed by a text format is binary.
+//              ]
+// *****************************************************************************
+const hexFormat             * hexSniffFormat(const char *head, size_t n);
+
+#endif /* HEXFORMAT_H */
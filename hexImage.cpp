@@ -0,0 +1,320 @@
+// *****************************************************************************
+// File         [ hexImage.cpp ]
+// Description  [ Implementation of the hexImage class ]
+// Author       [ Keith Sabine ]
+// *****************************************************************************
+
+#include "hexImage.h"
+#include "hexBits.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+// *****************************************************************************
+// Function     [ nextVersion ]
+// Description  [ A new version number, never handed out before ]
+// *****************************************************************************
+static uint64_t
+nextVersion()
+{
+    static std::atomic<uint64_t> counter(0);
+    return ++counter;
+}
+
+// *****************************************************************************
+// Function     [ constructor ]
+// Description  [ ]
+// *****************************************************************************
+hexImage::hexImage(uint8_t fill) :
+    m_Base(0),
+    m_Lo(0),
+    m_Hi(0),
+    m_Fill(fill),
+    m_Count(0),
+    m_Version(nextVersion())
+{
+}
+
+// *****************************************************************************
+// Function     [ clear ]
+// Description  [ ]
+// *****************************************************************************
+void
+hexImage::clear()
+{
+    m_Base = m_Lo = m_Hi = 0;
+    m_Count = 0;
+    m_Start = hexStartAddress();
+    m_Data.clear();
+    m_Used.clear();
+    m_Blocks.clear();
+    m_Version = nextVersion();
+}
+
+// *****************************************************************************
+// Function     [ setFill ]
+// Description  [ Change the erased value, rewriting any unset bytes ]
+// *****************************************************************************
+void
+hexImage::setFill(uint8_t f)
+{
+    if (f == m_Fill)
+        return;
+    m_Fill = f;
+    for (size_t i = 0; i < m_Data.size(); ++i) {
+        if (!isSet(i))
+            m_Data[i] = f;
+    }
+    m_Version = nextVersion();
+    std::fill(m_Blocks.begin(), m_Blocks.end(), m_Version);
+}
+
+// *****************************************************************************
+// Function     [ blockVersion ]
+// Description  [ The version at which block (address >> blockShift) last
+//                changed. A block the image doesn't cover is always new.
+//              ]
+// *****************************************************************************
+uint64_t
+hexImage::blockVersion(uint32_t block) const
+{
+    uint32_t first = m_Base >> blockShift;
+    if (block < first || block - first >= m_Blocks.size())
+        return m_Version;
+    return m_Blocks[block - first];
+}
+
+// *****************************************************************************
+// Function     [ touch ]
+// Description  [ Stamp the blocks holding buffer offsets [first, last) ]
+// *****************************************************************************
+void
+hexImage::touch(size_t first, size_t last)
+{
+    size_t base = m_Base >> blockShift;
+    size_t lo = ((m_Base + first) >> blockShift) - base;
+    size_t hi = ((m_Base + last - 1) >> blockShift) - base;
+    for (size_t b = lo; b <= hi; ++b) {
+        m_Blocks[b] = m_Version;
+    }
+}
+
+// *****************************************************************************
+// Function     [ contains ]
+// Description  [ True if the address has been written ]
+// *****************************************************************************
+bool
+hexImage::contains(uint32_t address) const
+{
+    if (address < m_Lo || address >= m_Hi)
+        return false;
+    return isSet(address - m_Base);
+}
+
+// *****************************************************************************
+// Function     [ overlaps ]
+// Description  [ True if any address in [address, address+n) has been written ]
+// *****************************************************************************
+bool
+hexImage::overlaps(uint32_t address, size_t n) const
+{
+    uint64_t lo = std::max<uint64_t>(address, m_Lo);
+    uint64_t hi = std::min<uint64_t>((uint64_t) address + n, m_Hi);
+    if (lo >= hi) {
+        return false;
+    }
+    size_t first = (size_t) (lo - m_Base);
+    return findBit(first, (size_t) (hi - m_Base), true) < (size_t) (hi - m_Base);
+}
+
+// *****************************************************************************
+// Function     [ at ]
+// Description  [ The byte at an address, or the fill value if unset ]
+// *****************************************************************************
+uint8_t
+hexImage::at(uint32_t address) const
+{
+    if (address < m_Lo || address >= m_Hi)
+        return m_Fill;
+    return m_Data[address - m_Base];
+}
+
+// *****************************************************************************
+// Function     [ reserve ]
+// Description  [ Grow the buffer so that it covers [lo, hi) ]
+// *****************************************************************************
+bool
+hexImage::reserve(uint32_t lo, uint32_t hi)
+{
+    if (m_Count == 0 && m_Data.empty()) {
+        if (hi - lo > maxExtent)
+            return false;
+        m_Base = lo & ~63u;
+        m_Lo = lo;
+        m_Hi = hi;
+        size_t n = ((hi - m_Base) + 63) & ~size_t(63);
+        m_Data.assign(n, m_Fill);
+        m_Used.assign(n / 64, 0);
+        m_Blocks.assign(((m_Base + n - 1) >> blockShift) - (m_Base >> blockShift) + 1, m_Version);
+        return true;
+    }
+
+    uint32_t newLo = std::min(lo, m_Lo);
+    uint32_t newHi = std::max(hi, m_Hi);
+    if (newHi - newLo > maxExtent)
+        return false;
+
+    // Growing downwards, shift everything up by whole bitmap words
+    uint32_t newBase = newLo & ~63u;
+    if (newBase < m_Base) {
+        size_t shift = m_Base - newBase;
+        m_Data.insert(m_Data.begin(), shift, m_Fill);
+        m_Used.insert(m_Used.begin(), shift / 64, 0);
+        m_Blocks.insert(m_Blocks.begin(), (m_Base >> blockShift) - (newBase >> blockShift), m_Version);
+        m_Base = newBase;
+    }
+
+    // Growing upwards, let the vectors grow geometrically
+    size_t n = ((newHi - m_Base) + 63) & ~size_t(63);
+    if (n > m_Data.size()) {
+        m_Data.resize(n, m_Fill);
+        m_Used.resize(n / 64, 0);
+        m_Blocks.resize(((m_Base + n - 1) >> blockShift) - (m_Base >> blockShift) + 1, m_Version);
+    }
+
+    m_Lo = newLo;
+    m_Hi = newHi;
+    return true;
+}
+
+// *****************************************************************************
+// Function     [ write ]
+// Description  [ Copy n bytes into the image at address. Returns false if
+//                this would stretch the image beyond maxExtent.
+//              ]
+// *****************************************************************************
+bool
+hexImage::write(uint32_t address, const uint8_t *data, size_t n)
+{
+    if (n == 0)
+        return true;
+    if (n > maxExtent || (uint64_t) address + n > UINT32_MAX)
+        return false;
+    m_Version = nextVersion();
+    if (!reserve(address, address + (uint32_t) n))
+        return false;
+
+    size_t first = address - m_Base;
+    std::memcpy(&m_Data[first], data, n);
+    touch(first, first + n);
+
+    // Mark the bits a word at a time, counting those newly set
+    size_t i = first;
+    size_t last = first + n;
+    while (i < last) {
+        size_t   bit  = i & 63;
+        size_t   len  = std::min<size_t>(64 - bit, last - i);
+        uint64_t mask = (len == 64) ? ~uint64_t(0) : (((uint64_t(1) << len) - 1) << bit);
+        uint64_t &w   = m_Used[i >> 6];
+        m_Count += hexBitCount(mask & ~w);
+        w |= mask;
+        i += len;
+    }
+    return true;
+}
+
+// *****************************************************************************
+// Function     [ findBit ]
+// Description  [ Index of the first bit at or after i that equals set,
+//                or end if there is none.
+//              ]
+// *****************************************************************************
+size_t
+hexImage::findBit(size_t i, size_t end, bool set) const
+{
+    while (i < end) {
+        uint64_t w = m_Used[i >> 6];
+        if (!set)
+            w = ~w;
+        w &= ~uint64_t(0) << (i & 63);
+        if (w != 0)
+            return std::min(end, (i & ~size_t(63)) + hexLowestBit(w));
+        i = (i & ~size_t(63)) + 64;
+    }
+    return end;
+}
+
+// *****************************************************************************
+// Function     [ hexSpanIterator ]
+// Description  [ An iterator at the first run starting at or after buffer
+//                offset pos.
+//              ]
+// *****************************************************************************
+hexSpanIterator::hexSpanIterator(const hexImage *image, size_t pos, size_t end) :
+    m_Image(image),
+    m_Pos(pos),
+    m_End(end),
+    m_Span { 0, nullptr, 0 }
+{
+    settle(pos);
+}
+
+// *****************************************************************************
+// Function     [ settle ]
+// Description  [ Move to the run starting at or after buffer offset i ]
+// *****************************************************************************
+void
+hexSpanIterator::settle(size_t i)
+{
+    m_Pos = (i < m_End) ? m_Image->findBit(i, m_End, true) : m_End;
+    if (m_Pos < m_End) {
+        size_t j = m_Image->findBit(m_Pos, m_End, false);
+        m_Span.address = m_Image->m_Base + (uint32_t) m_Pos;
+        m_Span.data    = &m_Image->m_Data[m_Pos];
+        m_Span.size    = j - m_Pos;
+    }
+    else {
+        m_Span = hexSpan { 0, nullptr, 0 };
+    }
+}
+
+// *****************************************************************************
+// Function     [ begin ]
+// Description  [ ]
+// *****************************************************************************
+hexSpanIterator
+hexSpanView::begin() const
+{
+    const hexImage *im = m_Image;
+    if (im->m_Data.empty())
+        return hexSpanIterator();
+    return hexSpanIterator(im, im->m_Lo - im->m_Base, im->m_Hi - im->m_Base);
+}
+
+// *****************************************************************************
+// Function     [ end ]
+// Description  [ ]
+// *****************************************************************************
+hexSpanIterator
+hexSpanView::end() const
+{
+    const hexImage *im = m_Image;
+    if (im->m_Data.empty())
+        return hexSpanIterator();
+    return hexSpanIterator(im, im->m_Hi - im->m_Base, im->m_Hi - im->m_Base);
+}
+
+// *****************************************************************************
+// Function     [ count ]
+// Description  [ ]
+// *****************************************************************************
+size_t
+hexSpanView::count() const
+{
+    size_t n = 0;
+    for (hexSpanIterator i = begin(); i != end(); ++i) {
+        n++;
+    }
+    return n;
+}
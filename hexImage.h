@@ -0,0 +1,189 @@
+#ifndef HEXIMAGE_H
+#define HEXIMAGE_H
+
+// *****************************************************************************
+// File         [ hexImage.h ]
+// Description  [ The image a HEX file loads into and a device is written
+//                from: one flat buffer over the addresses in use, holding
+//                the fill value where nothing was set, with a bitmap of the
+//                bytes that were. The occupied runs are walked as spans
+//                straight off the bitmap, and blocks carry versions so
+//                that a cache of the bytes can tell what has changed.
+//              ]
+// Author       [ Keith Sabine ]
+// *****************************************************************************
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+// *****************************************************************************
+// Class        [ hexSpan ]
+// Description  [ A contiguous run of occupied bytes in a hexImage. The data
+//                pointer refers into the image and is only valid until the
+//                image is next modified.
+//              ]
+// *****************************************************************************
+struct hexSpan
+{
+    uint32_t                  address;
+    const uint8_t           * data;
+    size_t                    size;
+};
+
+class hexImage;
+
+// *****************************************************************************
+// Class        [ hexSpanIterator ]
+// Description  [ Walks the occupied runs of an image straight off its
+//                bitmap, so iterating allocates and copies nothing.
+//              ]
+// *****************************************************************************
+class hexSpanIterator
+{
+public:
+    typedef std::forward_iterator_tag iterator_category;
+    typedef hexSpan           value_type;
+    typedef std::ptrdiff_t    difference_type;
+    typedef const hexSpan   * pointer;
+    typedef const hexSpan   & reference;
+
+    hexSpanIterator() : m_Image(nullptr), m_Pos(0), m_End(0), m_Span { 0, nullptr, 0 } {}
+    hexSpanIterator(const hexImage *image, size_t pos, size_t end);
+
+    reference                 operator*() const { return m_Span; }
+    pointer                   operator->() const { return &m_Span; }
+    hexSpanIterator         & operator++() { settle(m_Pos + m_Span.size); return *this; }
+    hexSpanIterator           operator++(int) { hexSpanIterator t = *this; ++*this; return t; }
+    bool                      operator==(const hexSpanIterator &o) const { return m_Pos == o.m_Pos; }
+    bool                      operator!=(const hexSpanIterator &o) const { return m_Pos != o.m_Pos; }
+
+private:
+    void                      settle(size_t i);
+
+    const hexImage          * m_Image;
+    size_t                    m_Pos;
+    size_t                    m_End;
+    hexSpan                   m_Span;
+};
+
+// *****************************************************************************
+// Class        [ hexSpanView ]
+// Description  [ The occupied runs of an image, in address order, as a
+//                range for iterating. Like hexSpan it is only valid until
+//                the image is next modified.
+//              ]
+// *****************************************************************************
+class hexSpanView
+{
+public:
+    explicit                  hexSpanView(const hexImage &image) : m_Image(&image) {}
+
+    hexSpanIterator           begin() const;
+    hexSpanIterator           end() const;
+    bool                      empty() const { return begin() == end(); }
+    // Number of runs; this walks the bitmap
+    size_t                    count() const;
+
+private:
+    const hexImage          * m_Image;
+};
+
+// *****************************************************************************
+// Class        [ hexStartAddress ]
+// Description  [ The execution start address carried by a HEX file, either
+//                as a CS:IP pair (record type 03) or a 32 bit EIP (05).
+//                For Segment, value holds CS in the top 16 bits and IP in
+//                the bottom 16.
+//              ]
+// *****************************************************************************
+struct hexStartAddress
+{
+    enum Kind
+    {
+        None,
+        Segment,
+        Linear
+    };
+
+    Kind                      kind = None;
+    uint32_t                  value = 0;
+};
+
+// *****************************************************************************
+// Class        [ hexImage ]
+// Description  [ The in-memory image of a device. Bytes are held in one flat
+//                buffer indexed by address, with a bitmap recording which
+//                addresses were actually set. Unset bytes hold the fill
+//                (erased) value, so the range baseAddress() to endAddress()
+//                can always be handed out as one contiguous block.
+//              ]
+// *****************************************************************************
+class hexImage
+{
+public:
+    // Largest extent (highest - lowest address) we will hold. This is far
+    // bigger than any part we program, and stops a stray address in a
+    // file from allocating gigabytes. Addresses are 32 bit, but the last
+    // byte of the address space can't be written as endAddress() would
+    // wrap.
+    static const uint32_t     maxExtent = 16 * 1024 * 1024;
+
+    explicit                  hexImage(uint8_t fill = 0xff);
+    ~hexImage() {}
+
+    void                      clear();
+    bool                      empty() const { return m_Count == 0; }
+    size_t                    size() const { return m_Count; }
+    uint32_t                  baseAddress() const { return m_Lo; }
+    uint32_t                  endAddress() const { return m_Hi; }
+    uint32_t                  extent() const { return m_Hi - m_Lo; }
+    uint8_t                   fill() const { return m_Fill; }
+    void                      setFill(uint8_t f);
+
+    bool                      contains(uint32_t address) const;
+    bool                      overlaps(uint32_t address, size_t n) const;
+    uint8_t                   at(uint32_t address) const;
+    bool                      write(uint32_t address, const uint8_t *data, size_t n);
+    bool                      write(uint32_t address, uint8_t d) { return write(address, &d, 1); }
+
+    // Every change to the bytes gets a new version, unique across all
+    // images, and the blocks it touched are stamped with it. A cache of
+    // something computed from the data can then tell what has changed.
+    static const uint32_t     blockShift = 12;
+    uint64_t                  version() const { return m_Version; }
+    uint64_t                  blockVersion(uint32_t block) const;
+
+    const hexStartAddress   & startAddress() const { return m_Start; }
+    void                      setStartAddress(const hexStartAddress &s) { m_Start = s; }
+
+    // Bytes from baseAddress() to endAddress(), gaps holding fill().
+    const uint8_t           * data() const { return m_Data.data() + (m_Lo - m_Base); }
+    hexSpanView               spans() const { return hexSpanView(*this); }
+
+private:
+    friend class              hexSpanIterator;
+    friend class              hexSpanView;
+
+    bool                      reserve(uint32_t lo, uint32_t hi);
+    void                      touch(size_t first, size_t last);
+    bool                      isSet(size_t i) const { return (m_Used[i >> 6] >> (i & 63)) & 1; }
+    size_t                    findBit(size_t i, size_t end, bool set) const;
+
+    // m_Base is m_Lo rounded down to a multiple of 64, so that the bitmap
+    // words line up with the data and growing downwards is a word shift.
+    uint32_t                  m_Base;
+    uint32_t                  m_Lo;
+    uint32_t                  m_Hi;
+    uint8_t                   m_Fill;
+    size_t                    m_Count;
+    hexStartAddress           m_Start;
+    std::vector<uint8_t>      m_Data;
+    std::vector<uint64_t>     m_Used;
+    // Versions of the blocks from m_Base >> blockShift
+    uint64_t                  m_Version;
+    std::vector<uint64_t>     m_Blocks;
+};
+
+#endif /* HEXIMAGE_H */
@@ -0,0 +1,179 @@
+// *****************************************************************************
+// File         [ hexMerge.cpp ]
+// Description  [ Implementation of the image merge ]
+// Author       [ Keith Sabine ]
+// *****************************************************************************
+
+#include "hexMerge.h"
+#include "hexDiff.h"
+
+#include <algorithm>
+
+// *****************************************************************************
+// Function     [ build ]
+// Description  [ ]
+// *****************************************************************************
+void
+hexIntervalIndex::build()
+{
+    std::sort(m_Intervals.begin(), m_Intervals.end(),
+              [](const interval &a, const interval &b) {
+                  return a.lo != b.lo ? a.lo < b.lo : a.hi < b.hi;
+              });
+    m_MaxHi.assign(m_Intervals.size(), 0);
+    buildNode(0, m_Intervals.size());
+}
+
+// *****************************************************************************
+// Function     [ buildNode ]
+// Description  [ The greatest end under the node for [l, r) ]
+// *****************************************************************************
+uint32_t
+hexIntervalIndex::buildNode(size_t l, size_t r)
+{
+    if (l >= r) {
+        return 0;
+    }
+    size_t m = l + (r - l) / 2;
+    uint32_t maxHi = m_Intervals[m].hi;
+    maxHi = std::max(maxHi, buildNode(l, m));
+    maxHi = std::max(maxHi, buildNode(m + 1, r));
+    m_MaxHi[m] = maxHi;
+    return maxHi;
+}
+
+// *****************************************************************************
+// Function     [ hexMergeIssueText ]
+// Description  [ ]
+// *****************************************************************************
+const char *
+hexMergeIssueText(hexMergeIssue::Kind kind)
+{
+    switch (kind) {
+    case hexMergeIssue::Overlap:      return "Overlapping identical data";
+    case hexMergeIssue::Conflict:     return "Conflicting data";
+    case hexMergeIssue::AddressRange: return "Address out of range";
+    }
+    return "Unknown issue";
+}
+
+// *****************************************************************************
+// Function     [ source ]
+// Description  [ Where an input keeps the byte that lands at address ]
+// *****************************************************************************
+static inline const uint8_t *
+source(const hexMergeInput &input, uint32_t address)
+{
+    const hexImage &image = *input.image;
+    return image.data() + ((int64_t) address - input.offset - image.baseAddress());
+}
+
+// *****************************************************************************
+// Function     [ fillGaps ]
+// Description  [ Write the fill over every gap between the image's runs ]
+// *****************************************************************************
+static bool
+fillGaps(hexImage &image, uint8_t fill)
+{
+    std::vector<std::pair<uint32_t, uint32_t> > gaps;
+    uint32_t end = image.baseAddress();
+    for (const hexSpan &span : image.spans()) {
+        if (span.address > end) {
+            gaps.push_back(std::make_pair(end, span.address));
+        }
+        end = span.address + (uint32_t) span.size;
+    }
+
+    const std::vector<uint8_t> block(4096, fill);
+    for (auto iter = gaps.begin(); iter != gaps.end(); ++iter) {
+        for (uint32_t a = iter->first; a < iter->second; ) {
+            uint32_t n = std::min<uint32_t>(iter->second - a, (uint32_t) block.size());
+            if (!image.write(a, block.data(), n)) {
+                return false;
+            }
+            a += n;
+        }
+    }
+    return true;
+}
+
+// *****************************************************************************
+// Function     [ hexMerge ]
+// Description  [ Index every run of every input where it will land, then
+//                look up each run's overlaps with runs of later inputs.
+//                Each pair is seen from both sides, so it is only taken
+//                from the earlier input's. Runs of one image never
+//                overlap each other.
+//              ]
+// *****************************************************************************
+bool
+hexMerge(const std::vector<hexMergeInput> &inputs, hexImage &image,
+         std::vector<hexMergeIssue> *issues, const hexMergeOptions &options)
+{
+    image.clear();
+    image.setFill(options.fill);
+
+    std::vector<hexMergeIssue> found;
+    bool ok = true;
+    hexIntervalIndex index;
+    for (uint32_t k = 0; k < inputs.size(); ++k) {
+        for (const hexSpan &span : inputs[k].image->spans()) {
+            int64_t lo = (int64_t) span.address + inputs[k].offset;
+            int64_t hi = lo + (int64_t) span.size;
+            if (lo < 0 || hi > (int64_t) UINT32_MAX) {
+                found.push_back(hexMergeIssue { hexMergeIssue::AddressRange, span.address,
+                                                (uint32_t) span.size, k, k });
+                ok = false;
+                continue;
+            }
+            index.add((uint32_t) lo, (uint32_t) hi, k);
+        }
+    }
+    index.build();
+
+    for (size_t i = 0; i < index.size(); ++i) {
+        const hexIntervalIndex::interval &a = index[i];
+        index.overlapping(a.lo, a.hi, [&](const hexIntervalIndex::interval &b) {
+            if (b.tag <= a.tag) {
+                return;
+            }
+            uint32_t lo = std::max(a.lo, b.lo);
+            uint32_t hi = std::min(a.hi, b.hi);
+            bool same = hexMismatch(source(inputs[a.tag], lo), source(inputs[b.tag], lo), hi - lo) == hi - lo;
+            found.push_back(hexMergeIssue { same ? hexMergeIssue::Overlap : hexMergeIssue::Conflict,
+                                            lo, hi - lo, a.tag, b.tag });
+            if (!same && !options.laterWins) {
+                ok = false;
+            }
+        });
+    }
+    std::stable_sort(found.begin(), found.end(),
+                     [](const hexMergeIssue &x, const hexMergeIssue &y) { return x.address < y.address; });
+
+    if (ok) {
+        // Later inputs are written over earlier ones
+        for (uint32_t k = 0; ok && k < inputs.size(); ++k) {
+            const hexImage &input = *inputs[k].image;
+            for (const hexSpan &span : input.spans()) {
+                uint32_t lo = (uint32_t) ((int64_t) span.address + inputs[k].offset);
+                if (!image.write(lo, span.data, span.size)) {
+                    found.push_back(hexMergeIssue { hexMergeIssue::AddressRange, span.address,
+                                                    (uint32_t) span.size, k, k });
+                    ok = false;
+                    break;
+                }
+            }
+            if (image.startAddress().kind == hexStartAddress::None) {
+                image.setStartAddress(input.startAddress());
+            }
+        }
+    }
+    if (ok && options.fillGaps) {
+        ok = fillGaps(image, options.fill);
+    }
+
+    if (issues != nullptr) {
+        issues->insert(issues->end(), found.begin(), found.end());
+    }
+    return ok;
+}
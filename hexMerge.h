@@ -0,0 +1,157 @@
+#ifndef HEXMERGE_H
+#define HEXMERGE_H
+
+// *****************************************************************************
+// File         [ hexMerge.h ]
+// Description  [ Merging several images, e.g. boot code, tables and patch
+//                areas from separate files, into the one that gets burnt.
+//                Where inputs overlap is found through an interval index
+//                over all their runs, and the gaps left between them can be
+//                filled with the device's erased value.
+//              ]
+// Author       [ Keith Sabine ]
+// *****************************************************************************
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "hexImage.h"
+
+// *****************************************************************************
+// Class        [ hexIntervalIndex ]
+// Description  [ Half open address intervals, each tagged, answering which
+//                of them overlap a query in O(log n + matches). The sorted
+//                intervals are treated as a balanced tree, the middle of
+//                each range being the node, with the greatest end in each
+//                subtree kept alongside so whole subtrees can be skipped.
+//              ]
+// *****************************************************************************
+class hexIntervalIndex
+{
+public:
+    struct interval
+    {
+        uint32_t              lo;
+        uint32_t              hi;
+        uint32_t              tag;
+    };
+
+    void                      clear() { m_Intervals.clear(); m_MaxHi.clear(); }
+    void                      add(uint32_t lo, uint32_t hi, uint32_t tag) { m_Intervals.push_back(interval { lo, hi, tag }); }
+    // Sort and index; call after the last add and before any query
+    void                      build();
+
+    size_t                    size() const { return m_Intervals.size(); }
+    const interval          & operator[](size_t i) const { return m_Intervals[i]; }
+
+    // Call fn(interval) for every interval overlapping [lo, hi), in order
+    template<typename F>
+    void                      overlapping(uint32_t lo, uint32_t hi, F fn) const
+    {
+        query(0, m_Intervals.size(), lo, hi, fn);
+    }
+
+private:
+    uint32_t                  buildNode(size_t l, size_t r);
+    template<typename F>
+    void                      query(size_t l, size_t r, uint32_t lo, uint32_t hi, F &fn) const;
+
+    std::vector<interval>     m_Intervals;
+    std::vector<uint32_t>     m_MaxHi;
+};
+
+// *****************************************************************************
+// Function     [ query ]
+// Description  [ Nothing under a node ends after lo if its greatest end
+//                doesn't, and nothing right of it starts before hi if it
+//                doesn't.
+//              ]
+// *****************************************************************************
+template<typename F>
+void
+hexIntervalIndex::query(size_t l, size_t r, uint32_t lo, uint32_t hi, F &fn) const
+{
+    if (l >= r) {
+        return;
+    }
+    size_t m = l + (r - l) / 2;
+    if (m_MaxHi[m] <= lo) {
+        return;
+    }
+    query(l, m, lo, hi, fn);
+    const interval &i = m_Intervals[m];
+    if (i.lo < hi) {
+        if (i.hi > lo) {
+            fn(i);
+        }
+        query(m + 1, r, lo, hi, fn);
+    }
+}
+
+// *****************************************************************************
+// Class        [ hexMergeInput ]
+// Description  [ One image to merge, moved by offset bytes (which may be
+//                negative).
+//              ]
+// *****************************************************************************
+struct hexMergeInput
+{
+    const hexImage          * image;
+    int64_t                   offset;
+};
+
+// *****************************************************************************
+// Class        [ hexMergeOptions ]
+// Description  [ ]
+// *****************************************************************************
+struct hexMergeOptions
+{
+    // What differing overlaps do: fail, or let the later input win
+    bool                      laterWins = false;
+    // Fill the gaps between inputs, so the result is one run
+    bool                      fillGaps = true;
+    // The device's erased value, for gaps and the result's fill
+    uint8_t                   fill = 0xff;
+};
+
+// *****************************************************************************
+// Class        [ hexMergeIssue ]
+// Description  [ Where two inputs meet, or one can't be placed. first and
+//                second are input indexes; second is unused for
+//                AddressRange.
+//              ]
+// *****************************************************************************
+struct hexMergeIssue
+{
+    enum Kind
+    {
+        Overlap,                 // both inputs have the same bytes here
+        Conflict,                // the inputs differ here
+        AddressRange             // the moved input doesn't fit the image
+    };
+
+    Kind                      kind;
+    uint32_t                  address;
+    uint32_t                  size;
+    uint32_t                  first;
+    uint32_t                  second;
+};
+
+// A short description of an issue kind, e.g. "Conflicting data"
+const char                  * hexMergeIssueText(hexMergeIssue::Kind kind);
+
+// *****************************************************************************
+// Function     [ hexMerge ]
+// Description  [ Merge the inputs, in order, into image (which is cleared
+//                first). Every overlap is reported to issues, if given, in
+//                address order. Identical overlaps are harmless; conflicts
+//                fail the merge unless options.laterWins. The start address
+//                is the first input's that has one. Returns false if any
+//                conflict or out of range input stopped the merge.
+//              ]
+// *****************************************************************************
+bool                          hexMerge(const std::vector<hexMergeInput> &inputs, hexImage &image,
+                                       std::vector<hexMergeIssue> *issues,
+                                       const hexMergeOptions &options = hexMergeOptions());
+
+#endif /* HEXMERGE_H */
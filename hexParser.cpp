@@ -0,0 +1,576 @@
+// *****************************************************************************
+// File         [ hexParser.cpp ]
+// Description  [ Intel HEX decoding straight from a byte buffer ]
+// Author       [ Keith Sabine ]
+// *****************************************************************************
+
+#include "hexParser.h"
+#include "hexCodec.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+// *****************************************************************************
+// Function     [ isBlank ]
+// Description  [ ]
+// *****************************************************************************
+static inline bool
+isBlank(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+// *****************************************************************************
+// Function     [ hexDiagnosticText ]
+// Description  [ ]
+// *****************************************************************************
+const char *
+hexDiagnosticText(hexDiagnostic::Kind kind)
+{
+    switch (kind) {
+    case hexDiagnostic::NoStartCode:   return "Not a HEX record";
+    case hexDiagnostic::BadByteCount:  return "Invalid byte count";
+    case hexDiagnostic::BadLength:     return "Record length does not match byte count";
+    case hexDiagnostic::BadAddress:    return "Invalid address";
+    case hexDiagnostic::BadRecordType: return "Invalid record type";
+    case hexDiagnostic::BadData:       return "Invalid byte";
+    case hexDiagnostic::BadChecksum:   return "Invalid checksum";
+    case hexDiagnostic::AddressRange:  return "Address out of range";
+    case hexDiagnostic::Overlap:       return "Data overlaps an earlier record";
+    }
+    return "Unknown error";
+}
+
+// *****************************************************************************
+// Class        [ hexRecord ]
+// Description  [ A decoded record. Its data lives in a separate buffer, at
+//                offset.
+//              ]
+// *****************************************************************************
+struct hexRecord
+{
+    uint32_t                  line;
+    uint32_t                  column;
+    uint32_t                  offset;
+    uint16_t                  address;
+    uint8_t                   type;
+    uint8_t                   count;
+};
+
+// *****************************************************************************
+// Class        [ hexSegment ]
+// Description  [ A run of whole lines, decoded independently of the others.
+//                Line numbers inside are relative to the segment start.
+//              ]
+// *****************************************************************************
+struct hexSegment
+{
+    const char              * begin;
+    const char              * end;
+    uint32_t                  lines = 0;
+    std::vector<hexRecord>    records;
+    std::vector<uint8_t>      data;
+    std::vector<hexDiagnostic> diagnostics;
+};
+
+// *****************************************************************************
+// Function     [ decodeLine ]
+// Description  [ Decode and checksum one line, [line, eol). Returns Record
+//                with rec filled in and its data appended to data, Blank
+//                for an empty line, or Error with the kind and column in
+//                diag. Anything that depends on earlier records (end of
+//                file, overlaps, extended addressing) is left to
+//                applyRecord.
+//              ]
+// *****************************************************************************
+enum lineResult
+{
+    Blank,
+    Record,
+    Error
+};
+
+static lineResult
+decodeLine(const char *line, const char *eol, std::vector<uint8_t> &data,
+           hexRecord &rec, hexDiagnostic &diag)
+{
+    const char *b = line;
+    const char *e = eol;
+
+    // Note a problem at character c of this line
+    auto report = [&](hexDiagnostic::Kind kind, const char *c) {
+        diag.column = (uint32_t) (c - line) + 1;
+        diag.kind   = kind;
+        return Error;
+    };
+
+    // Ignore surrounding white space, and blank lines
+    while (b < e && isBlank(*b)) {
+        ++b;
+    }
+    while (e > b && isBlank(e[-1])) {
+        --e;
+    }
+    if (b == e) {
+        return Blank;
+    }
+
+    // Get the start character
+    if (*b != ':') {
+        return report(hexDiagnostic::NoStartCode, b);
+    }
+    ++b;
+
+    // Byte count, address and record type are 4 bytes, then the
+    // data, then the checksum. Each byte is 2 characters.
+    size_t chars = e - b;
+    uint8_t byteCount = 0;
+    if (chars < 2 || !hexDecodePair(b, byteCount)) {
+        return report(hexDiagnostic::BadByteCount, b);
+    }
+    if (chars != 2 * (5 + (size_t) byteCount)) {
+        return report(hexDiagnostic::BadLength, e);
+    }
+
+    uint8_t hi = 0;
+    uint8_t lo = 0;
+    if (!hexDecodePair(b + 2, hi) || !hexDecodePair(b + 4, lo)) {
+        return report(hexDiagnostic::BadAddress, b + 2);
+    }
+
+    uint8_t recType = 0;
+    if (!hexDecodePair(b + 6, recType) || recType > 5) {
+        return report(hexDiagnostic::BadRecordType, b + 6);
+    }
+
+    // Extended address records carry 2 bytes, start addresses 4
+    static const int32_t fixedCount[6] = { -1, 0, 2, 4, 2, 4 };
+    if (fixedCount[recType] >= 0 && byteCount != fixedCount[recType]) {
+        return report(hexDiagnostic::BadByteCount, b);
+    }
+
+    // Get the bytes, then sum them
+    size_t offset = data.size();
+    data.resize(offset + byteCount);
+    uint8_t *bytes = data.data() + offset;
+    const char *s = b + 8;
+    if (!hexDecode(s, byteCount, bytes)) {
+        // Find the culprit for the report
+        uint8_t d = 0;
+        while (hexDecodePair(s, d)) {
+            s += 2;
+        }
+        data.resize(offset);
+        return report(hexDiagnostic::BadData, s);
+    }
+    s += 2 * byteCount;
+    uint32_t checkSum = byteCount + hi + lo + recType;
+    for (int32_t i = 0; i < byteCount; ++i) {
+        checkSum += bytes[i];
+    }
+
+    // The checksum makes the sum of all bytes zero
+    uint8_t cs = 0;
+    if (!hexDecodePair(s, cs) || ((checkSum + cs) & 0xff) != 0) {
+        data.resize(offset);
+        return report(hexDiagnostic::BadChecksum, s);
+    }
+
+    rec.column  = (uint32_t) (b + 2 - line) + 1;
+    rec.offset  = (uint32_t) offset;
+    rec.address = (uint16_t) ((hi << 8) | lo);
+    rec.type    = recType;
+    rec.count   = byteCount;
+    return Record;
+}
+
+// *****************************************************************************
+// Function     [ decodeSegment ]
+// Description  [ Decode each line of the segment ]
+// *****************************************************************************
+static void
+decodeSegment(hexSegment &seg)
+{
+    const char *p   = seg.begin;
+    const char *end = seg.end;
+    uint32_t lineNum = 0;
+
+    seg.records.reserve((end - p) / 44 + 1);
+    seg.data.reserve((end - p) / 2);
+
+    while (p < end) {
+        // Find the end of the line, and step over it for next time
+        const char *eol = (const char *) std::memchr(p, '\n', end - p);
+        if (eol == nullptr) {
+            eol = end;
+        }
+        const char *line = p;
+        p = (eol < end) ? eol + 1 : end;
+        lineNum++;
+
+        hexRecord rec;
+        hexDiagnostic diag;
+        lineResult result = decodeLine(line, eol, seg.data, rec, diag);
+        if (result == Record) {
+            rec.line = lineNum;
+            seg.records.push_back(rec);
+        }
+        else if (result == Error) {
+            diag.line = lineNum;
+            seg.diagnostics.push_back(diag);
+        }
+    }
+    seg.lines = lineNum;
+}
+
+// *****************************************************************************
+// Function     [ applyRecord ]
+// Description  [ Act on one decoded record, in file order: follow the
+//                extended address records (02 and 04), keep the last start
+//                address (03 or 05), and write data into the image, calling
+//                written(address, n) for each piece. Returns false at the
+//                end of file record.
+//              ]
+// *****************************************************************************
+template <typename Fn>
+static bool
+applyRecord(const hexRecord &rec, const uint8_t *data, uint32_t line, hexAddressState &state,
+            hexImage &image, std::vector<hexDiagnostic> &found, Fn written)
+{
+    uint32_t value = 0;
+    for (int32_t i = 0; i < rec.count && i < 4; ++i) {
+        value = (value << 8) | data[i];
+    }
+
+    if (rec.type == 1) {
+        // this is an end of file
+        return false;
+    }
+    else if (rec.type == 2) {
+        state.upper = value << 4;
+        state.segmented = true;
+        return true;
+    }
+    else if (rec.type == 4) {
+        state.upper = value << 16;
+        state.segmented = false;
+        return true;
+    }
+    else if (rec.type == 3 || rec.type == 5) {
+        hexStartAddress start;
+        start.kind  = (rec.type == 3) ? hexStartAddress::Segment : hexStartAddress::Linear;
+        start.value = value;
+        image.setStartAddress(start);
+        return true;
+    }
+
+    hexDiagnostic d;
+    d.line   = line;
+    d.column = rec.column;
+
+    // A segmented record that runs off the end of its 64k goes in
+    // two pieces, the second at the bottom of the segment.
+    const uint32_t upper = state.upper;
+    size_t first = rec.count;
+    if (state.segmented && rec.address + (size_t) rec.count > 0x10000) {
+        first = 0x10000 - rec.address;
+    }
+    uint64_t address = (uint64_t) upper + rec.address;
+    bool inRange = address <= UINT32_MAX;
+    bool overlap = inRange && image.overlaps((uint32_t) address, first);
+    if (first < rec.count) {
+        overlap = overlap || image.overlaps(upper, rec.count - first);
+    }
+    if (overlap) {
+        d.kind = hexDiagnostic::Overlap;
+        found.push_back(d);
+    }
+    if (inRange) {
+        inRange = image.write((uint32_t) address, data, first);
+        if (inRange) {
+            written((uint32_t) address, first);
+        }
+    }
+    if (inRange && first < rec.count) {
+        inRange = image.write(upper, data + first, rec.count - first);
+        if (inRange) {
+            written(upper, rec.count - first);
+        }
+    }
+    if (!inRange) {
+        d.kind = hexDiagnostic::AddressRange;
+        found.push_back(d);
+    }
+    return true;
+}
+
+// *****************************************************************************
+// Function     [ applySegments ]
+// Description  [ Apply the decoded records of every segment in file order,
+//                up to the end of file record. The diagnostics from every
+//                segment are gathered, renumbered and sorted, so the result
+//                is the same however the file was split.
+//              ]
+// *****************************************************************************
+static bool
+applySegments(std::vector<hexSegment> &segments, hexImage &image,
+              std::vector<hexDiagnostic> *diagnostics)
+{
+    std::vector<hexDiagnostic> found;
+    uint32_t lineBase = 0;
+    uint32_t eofLine = UINT32_MAX;
+    hexAddressState state;
+
+    for (auto seg = segments.begin(); seg != segments.end() && eofLine == UINT32_MAX; ++seg) {
+        for (auto rec = seg->records.begin(); rec != seg->records.end(); ++rec) {
+            uint32_t line = lineBase + rec->line;
+            const uint8_t *data = seg->data.data() + rec->offset;
+            if (!applyRecord(*rec, data, line, state, image, found, [](uint32_t, size_t) {})) {
+                eofLine = line;
+                break;
+            }
+        }
+        lineBase += seg->lines;
+    }
+
+    // Decode problems, renumbered, but none after the end of file
+    lineBase = 0;
+    for (auto seg = segments.begin(); seg != segments.end(); ++seg) {
+        for (auto d = seg->diagnostics.begin(); d != seg->diagnostics.end(); ++d) {
+            hexDiagnostic r = *d;
+            r.line += lineBase;
+            if (r.line < eofLine) {
+                found.push_back(r);
+            }
+        }
+        lineBase += seg->lines;
+    }
+
+    std::stable_sort(found.begin(), found.end(), [](const hexDiagnostic &a, const hexDiagnostic &b) {
+        return a.line < b.line || (a.line == b.line && a.column < b.column);
+    });
+
+    bool ok = found.empty();
+    if (diagnostics) {
+        diagnostics->insert(diagnostics->end(), found.begin(), found.end());
+    }
+    return ok;
+}
+
+// *****************************************************************************
+// Function     [ hexParse ]
+// Description  [ Split the buffer into segments at line boundaries, decode
+//                them on up to 'threads' threads, then apply them in order.
+//              ]
+// *****************************************************************************
+bool
+hexParse(const char *text, size_t length, hexImage &image,
+         std::vector<hexDiagnostic> *diagnostics, uint32_t threads)
+{
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    // Not worth starting threads for small files
+    const size_t minSegment = 256 * 1024;
+    if (length < 2 * minSegment) {
+        threads = 1;
+    }
+
+    // A few segments per thread, so that a slow one doesn't hold up the rest
+    size_t count = (threads == 1) ? 1 : std::min<size_t>(4 * threads, length / minSegment);
+    std::vector<hexSegment> segments;
+    segments.reserve(count);
+    const char *p   = text;
+    const char *end = text + length;
+    for (size_t i = 1; i <= count && p < end; ++i) {
+        const char *cut = (i == count) ? end : text + length * i / count;
+        if (cut < p) {
+            cut = p;
+        }
+        const char *eol = (cut < end) ? (const char *) std::memchr(cut, '\n', end - cut) : nullptr;
+        cut = (eol != nullptr) ? eol + 1 : end;
+        hexSegment seg;
+        seg.begin = p;
+        seg.end   = cut;
+        segments.push_back(std::move(seg));
+        p = cut;
+    }
+
+    if (threads == 1 || segments.size() == 1) {
+        for (auto seg = segments.begin(); seg != segments.end(); ++seg) {
+            decodeSegment(*seg);
+        }
+    }
+    else {
+        // Each worker takes the next undecoded segment until none are left
+        std::atomic<size_t> next(0);
+        auto worker = [&]() {
+            for (size_t i = next++; i < segments.size(); i = next++) {
+                decodeSegment(segments[i]);
+            }
+        };
+        std::vector<std::thread> pool;
+        for (uint32_t t = 1; t < threads && t < segments.size(); ++t) {
+            pool.emplace_back(worker);
+        }
+        worker();
+        for (auto t = pool.begin(); t != pool.end(); ++t) {
+            t->join();
+        }
+    }
+
+    return applySegments(segments, image, diagnostics);
+}
+
+// *****************************************************************************
+// Function     [ hexParse ]
+// Description  [ As above, returning the image and diagnostics together ]
+// *****************************************************************************
+hexParseResult
+hexParse(const char *text, size_t length, uint32_t threads)
+{
+    hexParseResult result;
+    hexParse(text, length, result.image, &result.diagnostics, threads);
+    return result;
+}
+
+// *****************************************************************************
+// Function     [ constructor ]
+// Description  [ ]
+// *****************************************************************************
+hexStreamParser::hexStreamParser(hexImage &image) :
+    m_Image(image),
+    m_Line(0),
+    m_Overlong(false),
+    m_Done(false)
+{
+}
+
+// *****************************************************************************
+// Function     [ reset ]
+// Description  [ Start again on a new stream. The image is left alone. ]
+// *****************************************************************************
+void
+hexStreamParser::reset()
+{
+    m_Partial.clear();
+    m_Data.clear();
+    m_Diagnostics.clear();
+    m_State = hexAddressState();
+    m_Line = 0;
+    m_Overlong = false;
+    m_Done = false;
+}
+
+// *****************************************************************************
+// Function     [ feed ]
+// Description  [ Take the next slice of the stream. Whole lines are parsed
+//                where they lie in the slice; only a line split across
+//                slices is copied, into m_Partial, until its end arrives.
+//              ]
+// *****************************************************************************
+void
+hexStreamParser::feed(const char *data, size_t n)
+{
+    const char *p   = data;
+    const char *end = data + n;
+
+    while (p < end && !m_Done) {
+        const char *eol = (const char *) std::memchr(p, '\n', end - p);
+        if (eol == nullptr) {
+            // Keep the start of the line for next time, but no more of
+            // it than any real record could need.
+            size_t room = (m_Partial.size() < maxLine) ? maxLine - m_Partial.size() : 0;
+            size_t keep = std::min<size_t>(room, end - p);
+            m_Partial.append(p, keep);
+            m_Overlong = m_Overlong || keep < (size_t) (end - p);
+            return;
+        }
+
+        if (m_Partial.empty() && !m_Overlong) {
+            parseLine(p, eol);
+        }
+        else {
+            size_t room = (m_Partial.size() < maxLine) ? maxLine - m_Partial.size() : 0;
+            size_t keep = std::min<size_t>(room, eol - p);
+            m_Partial.append(p, keep);
+            m_Overlong = m_Overlong || keep < (size_t) (eol - p);
+            parseLine(m_Partial.data(), m_Partial.data() + m_Partial.size());
+            m_Partial.clear();
+            m_Overlong = false;
+        }
+        p = eol + 1;
+    }
+}
+
+// *****************************************************************************
+// Function     [ finish ]
+// Description  [ The stream has ended: parse any last line that had no
+//                newline. Returns true if there were no errors.
+//              ]
+// *****************************************************************************
+bool
+hexStreamParser::finish()
+{
+    if (!m_Done && (!m_Partial.empty() || m_Overlong)) {
+        parseLine(m_Partial.data(), m_Partial.data() + m_Partial.size());
+    }
+    m_Partial.clear();
+    m_Overlong = false;
+    return ok();
+}
+
+// *****************************************************************************
+// Function     [ parseLine ]
+// Description  [ Decode and apply one line, passing on what it produced ]
+// *****************************************************************************
+void
+hexStreamParser::parseLine(const char *line, const char *eol)
+{
+    m_Line++;
+    size_t before = m_Diagnostics.size();
+
+    hexRecord rec;
+    hexDiagnostic diag;
+    m_Data.clear();
+    lineResult result = decodeLine(line, eol, m_Data, rec, diag);
+
+    // Only the start of an overlong line was kept. It may still show
+    // what's wrong, else the line was just too long.
+    if (m_Overlong && (result != Error || diag.kind == hexDiagnostic::BadLength)) {
+        result      = Error;
+        diag.column = (uint32_t) maxLine + 1;
+        diag.kind   = hexDiagnostic::BadLength;
+    }
+
+    if (result == Error) {
+        diag.line = m_Line;
+        m_Diagnostics.push_back(diag);
+    }
+    else if (result == Record) {
+        hexStreamRecord out;
+        out.line    = m_Line;
+        out.type    = rec.type;
+        out.address = m_State.upper + rec.address;
+        out.data    = m_Data.data() + rec.offset;
+        out.count   = rec.count;
+
+        m_Done = !applyRecord(rec, out.data, m_Line, m_State, m_Image, m_Diagnostics,
+                              [this](uint32_t address, size_t n) {
+            if (m_OnUpdate) {
+                m_OnUpdate(address, n);
+            }
+        });
+        if (m_OnRecord) {
+            m_OnRecord(out);
+        }
+    }
+
+    if (m_OnDiagnostic) {
+        for (size_t i = before; i < m_Diagnostics.size(); ++i) {
+            m_OnDiagnostic(m_Diagnostics[i]);
+        }
+    }
+}
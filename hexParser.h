@@ -0,0 +1,166 @@
+#ifndef HEXPARSER_H
+#define HEXPARSER_H
+
+// *****************************************************************************
+// File         [ hexParser.h ]
+// Description  [ Intel HEX decoding straight from a byte buffer. Nothing
+//                here touches the GUI, so it can run on any thread.
+//              ]
+// Author       [ Keith Sabine ]
+// *****************************************************************************
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "hexImage.h"
+
+// *****************************************************************************
+// Class        [ hexDiagnostic ]
+// Description  [ A problem found while parsing. Lines and columns count
+//                from 1; the column is that of the offending character.
+//              ]
+// *****************************************************************************
+struct hexDiagnostic
+{
+    enum Kind
+    {
+        NoStartCode,
+        BadByteCount,
+        BadLength,
+        BadAddress,
+        BadRecordType,
+        BadData,
+        BadChecksum,
+        AddressRange,
+        Overlap
+    };
+
+    uint32_t                  line;
+    uint32_t                  column;
+    Kind                      kind;
+};
+
+// A short description of a diagnostic kind, e.g. "Invalid checksum"
+const char                  * hexDiagnosticText(hexDiagnostic::Kind kind);
+
+// *****************************************************************************
+// Class        [ hexParseResult ]
+// Description  [ The image decoded from a file, and everything wrong with it ]
+// *****************************************************************************
+struct hexParseResult
+{
+    hexImage                  image;
+    std::vector<hexDiagnostic> diagnostics;
+
+    bool                      ok() const { return diagnostics.empty(); }
+};
+
+// *****************************************************************************
+// Function     [ hexParse ]
+// Description  [ Decode the Intel HEX text in [text, text+length) into image.
+//                The buffer is read in place, so it can be a memory mapped
+//                file. All six record types are understood: extended
+//                segment (02) and linear (04) addresses give 32 bit data
+//                addresses, and the start address (03 or 05) is kept in
+//                the image. Stops at the end of file record. A bad record is
+//                reported to diagnostics (if given) and skipped, so one
+//                pass finds every error. Returns true if there were none.
+//
+//                Large files are split at line boundaries and decoded on
+//                up to 'threads' threads (0 means one per core), then
+//                merged in file order, so the image and diagnostics are
+//                the same as a single threaded parse.
+//              ]
+// *****************************************************************************
+bool                          hexParse(const char *text, size_t length, hexImage &image,
+                                       std::vector<hexDiagnostic> *diagnostics,
+                                       uint32_t threads = 1);
+
+hexParseResult                hexParse(const char *text, size_t length, uint32_t threads = 1);
+
+// *****************************************************************************
+// Class        [ hexAddressState ]
+// Description  [ The upper address from the last 02 or 04 record. Segment
+//                addresses wrap within their 64k, linear ones carry on into
+//                the next 64k.
+//              ]
+// *****************************************************************************
+struct hexAddressState
+{
+    uint32_t                  upper = 0;
+    bool                      segmented = false;
+};
+
+// *****************************************************************************
+// Class        [ hexStreamRecord ]
+// Description  [ A good record, as the stream parser hands it on. For data
+//                records address includes any 02 or 04 offset. The data
+//                pointer is only valid during the callback.
+//              ]
+// *****************************************************************************
+struct hexStreamRecord
+{
+    uint32_t                  line;
+    uint8_t                   type;
+    uint32_t                  address;
+    const uint8_t           * data;
+    uint8_t                   count;
+};
+
+// *****************************************************************************
+// Class        [ hexStreamParser ]
+// Description  [ Intel HEX parsing for data that arrives a piece at a time,
+//                from a pipe, socket, decompressor or serial port. Slices
+//                of any size are fed in; each record is decoded and applied
+//                to the image as soon as its line is complete, and the
+//                optional callbacks are told of records, bytes written and
+//                problems as they happen. The result is the same as
+//                hexParse on the whole text.
+//              ]
+// *****************************************************************************
+class hexStreamParser
+{
+public:
+    typedef std::function<void(const hexStreamRecord &)>   recordHandler;
+    typedef std::function<void(uint32_t address, size_t n)> updateHandler;
+    typedef std::function<void(const hexDiagnostic &)>     diagnosticHandler;
+
+    // Longest line kept; a record is at most 1 + 2 * 260 characters
+    static const size_t       maxLine = 1024;
+
+    explicit                  hexStreamParser(hexImage &image);
+    ~hexStreamParser() {}
+
+    void                      setRecordHandler(const recordHandler &h) { m_OnRecord = h; }
+    void                      setUpdateHandler(const updateHandler &h) { m_OnUpdate = h; }
+    void                      setDiagnosticHandler(const diagnosticHandler &h) { m_OnDiagnostic = h; }
+
+    void                      feed(const char *data, size_t n);
+    bool                      finish();
+    void                      reset();
+
+    // True once the end of file record is seen; later input is ignored
+    bool                      done() const { return m_Done; }
+    bool                      ok() const { return m_Diagnostics.empty(); }
+    uint32_t                  lines() const { return m_Line; }
+    const std::vector<hexDiagnostic> &diagnostics() const { return m_Diagnostics; }
+
+private:
+    void                      parseLine(const char *line, const char *eol);
+
+    hexImage                & m_Image;
+    std::string               m_Partial;
+    std::vector<uint8_t>      m_Data;
+    std::vector<hexDiagnostic> m_Diagnostics;
+    hexAddressState           m_State;
+    uint32_t                  m_Line;
+    bool                      m_Overlong;
+    bool                      m_Done;
+    recordHandler             m_OnRecord;
+    updateHandler             m_OnUpdate;
+    diagnosticHandler         m_OnDiagnostic;
+};
+
+#endif /* HEXPARSER_H */
@@ -0,0 +1,819 @@
+// *****************************************************************************
+// File         [ programmer.cpp ]
+// Description  [ Implementation of the programmer class ]
+// Author       [ Keith Sabine ]
+// *****************************************************************************
+
+#include "programmer.h"
+#include "burnEngine.h"
+#include "wireBlocks.h"
+#include "wireProtocol.h"
+#include "wireReply.h"
+
+#include <QDeadlineTimer>
+#include <QMutexLocker>
+#include <QPromise>
+#include <QTime>
+#include <QtSerialPort/QSerialPort>
+
+#include <cstdlib>
+#include <memory>
+
+// *****************************************************************************
+// Function     [ device ]
+// Description  [ The traits of the device named, as values. One the PIC
+//                doesn't know is taken as a 2KB device erasing to 0xff.
+//              ]
+// *****************************************************************************
+static deviceInfo
+device(const QString &devType)
+{
+    deviceInfo info;
+    if (!deviceFind(devType.toStdString(), info)) {
+        info.capacity = 2048;
+    }
+    return info;
+}
+
+// *****************************************************************************
+// Class        [ burnVisitor ]
+// Description  [ Runs the burnEngine built for whichever device deviceVisit
+//                finds
+//              ]
+// *****************************************************************************
+struct burnVisitor
+{
+    QSerialPort                        & serial;
+    const burnSettings                 & settings;
+    const hexSpanView                  & spans;
+    const std::function<void(int32_t)> & progress;
+    burnReport                           report;
+
+    template <class Device>
+    void operator()(Device)
+    {
+        burnEngine<Device> engine(settings);
+        report = engine.burn(serial, spans, progress);
+    }
+};
+
+
+// *****************************************************************************
+// Function     [ constructor ]
+// Description  [ The hub's answers are taken in its thread, straight to the
+//                operation waiting on them.
+//              ]
+// *****************************************************************************
+programmer::programmer(serialHub *hub, QObject *parent) :
+    QObject(parent),
+    m_hub(hub),
+    m_limit(programmerQueueDefault),
+    m_queued(0),
+    m_running(false),
+    m_level(0)
+{
+    QObject::connect(m_hub, &serialHub::replied, this, &programmer::replied, Qt::DirectConnection);
+    QObject::connect(m_hub, &serialHub::timedOut, this, &programmer::timedOut, Qt::DirectConnection);
+    QObject::connect(m_hub, &serialHub::failed, this, &programmer::failed, Qt::DirectConnection);
+}
+
+// *****************************************************************************
+// Function     [ destructor ]
+// Description  [ Futures still waiting are cancelled with their promises ]
+// *****************************************************************************
+programmer::~programmer()
+{
+}
+
+// *****************************************************************************
+// Function     [ setQueueLimit ]
+// Description  [ ]
+// *****************************************************************************
+void
+programmer::setQueueLimit(size_t n)
+{
+    QMutexLocker lock(&m_mutex);
+    m_limit = n > 0 ? n : 1;
+}
+
+// *****************************************************************************
+// Function     [ waitForRoom ]
+// Description  [ Not from the hub's thread, which is the one making room ]
+// *****************************************************************************
+bool
+programmer::waitForRoom(int32_t mS)
+{
+    QMutexLocker lock(&m_mutex);
+    QDeadlineTimer deadline(mS);
+    while (m_queued >= m_limit) {
+        if (!m_room.wait(&m_mutex, deadline)) {
+            return m_queued < m_limit;
+        }
+    }
+    return true;
+}
+
+// *****************************************************************************
+// Function     [ start ]
+// Description  [ The operation at the front of the queue. Only called with
+//                m_running set, so no other is under way.
+//              ]
+// *****************************************************************************
+void
+programmer::start()
+{
+    std::function<void()> operation;
+    {
+        QMutexLocker lock(&m_mutex);
+        operation = m_operations.front();
+        m_operations.pop_front();
+    }
+    operation();
+}
+
+// *****************************************************************************
+// Function     [ release ]
+// Description  [ An operation is over, one way or another, so start the
+//                next, if there is one
+//              ]
+// *****************************************************************************
+void
+programmer::release()
+{
+    {
+        QMutexLocker lock(&m_mutex);
+        --m_queued;
+        m_room.wakeAll();
+        if (m_operations.empty()) {
+            m_running = false;
+            return;
+        }
+    }
+    start();
+}
+
+// *****************************************************************************
+// Function     [ submit ]
+// Description  [ Queue body, to start once the operations before it are
+//                over. It is handed the promise and what to call with the
+//                result, which it may do from any thread.
+//              ]
+// *****************************************************************************
+template <class Result, class Body>
+QFuture<Result>
+programmer::submit(const programmerSettings &s, Body body)
+{
+    std::shared_ptr<QPromise<Result>> promise = std::make_shared<QPromise<Result>>();
+    QFuture<Result> future = promise->future();
+    promise->start();
+
+    QMutexLocker lock(&m_mutex);
+    if (s.portName.isEmpty() || m_queued >= m_limit) {
+        Result r;
+        if (s.portName.isEmpty()) {
+            r.error = tr("No port name specified");
+        }
+        else {
+            r.status = programmerResult::Busy;
+            r.error = tr("Programmer busy, %1 operations queued").arg(m_queued);
+        }
+        promise->addResult(r);
+        promise->finish();
+        return future;
+    }
+    ++m_queued;
+
+    m_operations.push_back([this, promise, body]() {
+        body(*promise, [this, promise](const Result &r) {
+            promise->addResult(r);
+            promise->finish();
+            release();
+        });
+    });
+    if (m_running) {
+        return future;
+    }
+    m_running = true;
+    lock.unlock();
+    start();
+    return future;
+}
+
+// *****************************************************************************
+// Function     [ ask ]
+// Description  [ One request and its reply, as an exchange on the hub. then
+//                is called with the answer, in the hub's thread. The lock is
+//                held until the exchange's id has been noted, so that its
+//                answer can't look for it sooner.
+//              ]
+// *****************************************************************************
+void
+programmer::ask(const programmerSettings &s, const QByteArray &request,
+                const wireReply &reply, int32_t timeout, int32_t gap,
+                const answerFunc &then)
+{
+    serialExchange x;
+    x.portName = s.portName;
+    x.baudRate = s.baudRate;
+    x.flowControl = s.flowControl;
+    x.request = request;
+    x.reply = reply;
+    x.timeout = timeout;
+    x.gap = gap;
+
+    QMutexLocker lock(&m_mutex);
+    const int32_t id = m_hub->exchange(x);
+    m_waiting[id] = { reply, then };
+}
+
+// *****************************************************************************
+// Function     [ job ]
+// Description  [ body, run with the port in the hub's thread. If the port
+//                won't open it never runs, and unopened is told why instead.
+//              ]
+// *****************************************************************************
+void
+programmer::job(const programmerSettings &s, const serialJob &body,
+                const answerFunc &unopened)
+{
+    std::shared_ptr<int32_t> id = std::make_shared<int32_t>(0);
+    serialExchange x;
+    x.portName = s.portName;
+    x.baudRate = s.baudRate;
+    x.flowControl = s.flowControl;
+    x.job = [this, body, id](QSerialPort &serial) {
+        {
+            QMutexLocker lock(&m_mutex);
+            m_waiting.erase(*id);
+        }
+        body(serial);
+    };
+
+    QMutexLocker lock(&m_mutex);
+    *id = m_hub->exchange(x);
+    m_waiting[*id] = { wireReply(), unopened };
+}
+
+// *****************************************************************************
+// Function     [ dispatch ]
+// Description  [ Hand the hub's answer to whatever is waiting on it. A
+//                reply is fed to a copy of the reply's shape, for the
+//                operation to look at.
+//              ]
+// *****************************************************************************
+void
+programmer::dispatch(int32_t id, answer &a)
+{
+    waiting w;
+    {
+        QMutexLocker lock(&m_mutex);
+        auto iter = m_waiting.find(id);
+        if (iter == m_waiting.end()) {
+            return;
+        }
+        w = iter->second;
+        m_waiting.erase(iter);
+    }
+    if (a.kind == answer::Replied) {
+        a.reply = w.reply;
+        a.reply.reset();
+        a.reply.feed(a.data.constData(), (size_t) a.data.size());
+    }
+    w.then(a);
+}
+
+// *****************************************************************************
+// Function     [ replied ]
+// Description  [ ]
+// *****************************************************************************
+void
+programmer::replied(int32_t id, const QByteArray &data)
+{
+    answer a;
+    a.kind = answer::Replied;
+    a.data = data;
+    dispatch(id, a);
+}
+
+// *****************************************************************************
+// Function     [ timedOut ]
+// Description  [ ]
+// *****************************************************************************
+void
+programmer::timedOut(int32_t id, bool written)
+{
+    answer a;
+    a.kind = answer::TimedOut;
+    a.written = written;
+    dispatch(id, a);
+}
+
+// *****************************************************************************
+// Function     [ failed ]
+// Description  [ The port wouldn't open, or failed part way ]
+// *****************************************************************************
+void
+programmer::failed(int32_t id, const QString &why)
+{
+    answer a;
+    a.kind = answer::Failed;
+    a.why = why;
+    dispatch(id, a);
+}
+
+// *****************************************************************************
+// Function     [ heard ]
+// Description  [ True if there was a reply. If not, false, with the
+//                result's status and error set.
+//              ]
+// *****************************************************************************
+bool
+programmer::heard(const answer &a, programmerResult &r, const QString &what)
+{
+    switch (a.kind) {
+    case answer::Replied:
+        return true;
+    case answer::TimedOut:
+        r.status = programmerResult::TimedOut;
+        if (!a.written) {
+            r.error = QString("Wait write request timeout %1").arg(QTime::currentTime().toString());
+        }
+        else {
+            r.error = QString("%1 timeout %2").arg(what).arg(QTime::currentTime().toString());
+        }
+        return false;
+    default:
+        r.status = programmerResult::Failed;
+        r.error = a.why;
+        return false;
+    }
+}
+
+// *****************************************************************************
+// Function     [ init ]
+// Description  [ ]
+// *****************************************************************************
+QFuture<initResult>
+programmer::init(const programmerSettings &s)
+{
+    return submit<initResult>(s, [this, s](QPromise<initResult> &, const initFunc &done) {
+        doInit(s, done);
+    });
+}
+
+// *****************************************************************************
+// Function     [ read ]
+// Description  [ ]
+// *****************************************************************************
+QFuture<readResult>
+programmer::read(const programmerSettings &s)
+{
+    return submit<readResult>(s, [this, s](QPromise<readResult> &, const readFunc &done) {
+        doRead(s, done);
+    });
+}
+
+// *****************************************************************************
+// Function     [ blankCheck ]
+// Description  [ ]
+// *****************************************************************************
+QFuture<checkResult>
+programmer::blankCheck(const programmerSettings &s)
+{
+    return submit<checkResult>(s, [this, s](QPromise<checkResult> &, const checkFunc &done) {
+        doBlankCheck(s, done);
+    });
+}
+
+// *****************************************************************************
+// Function     [ write ]
+// Description  [ The promise lasts as long as done, which the burn holds on
+//                to, so progress can report to it.
+//              ]
+// *****************************************************************************
+QFuture<writeResult>
+programmer::write(const programmerSettings &s, const std::shared_ptr<const hexImage> &image)
+{
+    return submit<writeResult>(s, [this, s, image](QPromise<writeResult> &promise, const writeFunc &done) {
+        promise.setProgressRange(0, 100);
+        QPromise<writeResult> *p = &promise;
+        doWrite(s, image, [p](int32_t pct) { p->setProgressValue(pct); }, done);
+    });
+}
+
+// *****************************************************************************
+// Function     [ verify ]
+// Description  [ ]
+// *****************************************************************************
+QFuture<verifyResult>
+programmer::verify(const programmerSettings &s, const std::shared_ptr<const hexImage> &image)
+{
+    return submit<verifyResult>(s, [this, s, image](QPromise<verifyResult> &, const verifyFunc &done) {
+        doVerify(s, image, done);
+    });
+}
+
+// *****************************************************************************
+// Function     [ run ]
+// Description  [ The whole pipeline is one operation, so nothing else gets
+//                in between its steps. Progress is the write's.
+//              ]
+// *****************************************************************************
+QFuture<pipelineResult>
+programmer::run(const programmerSettings &s, const programmerPipeline &pipeline,
+                const std::shared_ptr<const hexImage> &image)
+{
+    return submit<pipelineResult>(s, [this, s, pipeline, image](QPromise<pipelineResult> &promise,
+                                                                const pipelineFunc &done) {
+        promise.setProgressRange(0, 100);
+        QPromise<pipelineResult> *p = &promise;
+        std::shared_ptr<pipelineRun> run = std::make_shared<pipelineRun>();
+        run->settings = s;
+        run->pipeline = pipeline;
+        run->image = image;
+        run->progress = [p](int32_t pct) { p->setProgressValue(pct); };
+        run->done = done;
+        doPipeline(run);
+    });
+}
+
+// *****************************************************************************
+// Function     [ reset ]
+// Description  [ The programmer says nothing back. The reply never
+//                completes, so the exchange lasts 50mS, which gives it that
+//                to reset in before whatever is queued after goes.
+//              ]
+// *****************************************************************************
+QFuture<programmerResult>
+programmer::reset(const programmerSettings &s)
+{
+    typedef std::function<void(const programmerResult &)> resetFunc;
+    return submit<programmerResult>(s, [this, s](QPromise<programmerResult> &, const resetFunc &done) {
+        m_level = 0;
+        ask(s, CMD_RSET, wireReply::open(), 50, 50, [done](const answer &a) {
+            programmerResult r;
+            if (a.kind == answer::Failed || (a.kind == answer::TimedOut && !a.written)) {
+                r.status = a.kind == answer::Failed ? programmerResult::Failed : programmerResult::TimedOut;
+                r.error = a.kind == answer::Failed ? a.why
+                        : QString("Send reset timeout %1").arg(QTime::currentTime().toString());
+            }
+            else {
+                r.status = programmerResult::Done;
+            }
+            done(r);
+        });
+    });
+}
+
+// *****************************************************************************
+// Function     [ doInit ]
+// Description  [ U to set the baud rate, then, for a device the PIC has a
+//                type for, the protocol level and the type. The type goes
+//                once the protocol is known, since firmware that frames
+//                its replies sends its OK framed.
+//              ]
+// *****************************************************************************
+void
+programmer::doInit(const programmerSettings &s, const initFunc &done)
+{
+    m_level = 0;
+
+    // Send the cmd, ascii U or 0x55. The PIC answers with its baud rate
+    // divisor, for a 20MHz clock, complete once it has as many digits as
+    // the one we expect.
+    const int32_t divisor = (int32_t) (20.0e6 / (4.0 * s.baudRate) + 0.5) - 1;
+    wireReply baud = wireReply::digits(QString::number(divisor).size());
+    ask(s, CMD_INIT, baud, s.timeout, 10, [this, s, done](const answer &a) {
+        initResult r;
+        if (!heard(a, r, "Read baud rate")) {
+            done(r);
+            return;
+        }
+        bool ok = false;
+        const int32_t reported = a.data.toInt(&ok);
+        if (!ok) {
+            r.error = QString("Failed to initialise serial link to %1 baud").arg(s.baudRate);
+            done(r);
+            return;
+        }
+        r.divisor = reported;
+        r.baudRate = (int32_t) (20.0e6 / (4 * (r.divisor + 1)));
+        r.baudOk = std::abs(100 * (r.baudRate - s.baudRate) / s.baudRate) < 5;
+
+        if (device(s.devType).type == 0) {
+            r.status = programmerResult::Done;
+            done(r);
+            return;
+        }
+        initLevel(s, r, done);
+    });
+}
+
+// *****************************************************************************
+// Function     [ initLevel ]
+// Description  [ Ask for binary framing. Older firmware ignores the cmd and
+//                says nothing, so don't wait long, and stay with ASCII if
+//                so. Level 1 is binary framing, 2 block writes as well, 3
+//                framed replies too.
+//              ]
+// *****************************************************************************
+void
+programmer::initLevel(const programmerSettings &s, const initResult &r, const initFunc &done)
+{
+    wireReply protocol = wireReply::token({ wireBinaryReply, wireBlockReply, wireFramedReply });
+    ask(s, CMD_PROT, protocol, 250, 10, [this, s, r, done](const answer &a) {
+        initResult next = r;
+        if (a.kind == answer::Replied) {
+            if (a.data.startsWith(wireFramedReply)) {
+                next.level = 3;
+            }
+            else if (a.data.startsWith(wireBlockReply)) {
+                next.level = 2;
+            }
+            else if (a.data.startsWith(wireBinaryReply)) {
+                next.level = 1;
+            }
+        }
+        m_level = next.level;
+        initType(s, next, done);
+    });
+}
+
+// *****************************************************************************
+// Function     [ initType ]
+// Description  [ Now send a device type cmd. A framed reply that fails its
+//                CRC is said to, rather than taken for a wrong device type.
+//              ]
+// *****************************************************************************
+void
+programmer::initType(const programmerSettings &s, const initResult &r, const initFunc &done)
+{
+    const bool framed = r.level >= 3;
+    wireReply type = framed ? wireReply::status() : wireReply::token({ "OK" });
+    const QByteArray request = QByteArray(CMD_TYPE) + device(s.devType).type;
+    ask(s, request, type, s.timeout, 10, [s, r, framed, done](const answer &a) {
+        initResult next = r;
+        if (!heard(a, next, "Read devType")) {
+            done(next);
+            return;
+        }
+        if (framed && !a.reply.ok()) {
+            next.error = QString("Bad reply frame to the device type, %1 bytes").arg(a.data.size());
+            done(next);
+            return;
+        }
+        const QString status = framed ? QString::fromStdString(a.reply.text()) : QString::fromUtf8(a.data);
+        if (status != "OK") {
+            next.error = QString("Bad device type %1").arg(s.devType);
+            done(next);
+            return;
+        }
+        next.typeSet = true;
+        next.status = programmerResult::Done;
+        done(next);
+    });
+}
+
+// *****************************************************************************
+// Function     [ doRead ]
+// Description  [ Read cmds are just 2 bytes. The reply is complete at the
+//                end of the frame, or of the dump's last line. Either way
+//                only a dump that checks out is Done; a garbled one is an
+//                error, not bytes that would read as failures to check or
+//                verify.
+//              ]
+// *****************************************************************************
+void
+programmer::doRead(const programmerSettings &s, const readFunc &done)
+{
+    const bool binary = m_level >= 1;
+    wireReply reply = binary ? wireReply::frame(wireFrame::Dump) : wireReply::dump(device(s.devType).capacity);
+    ask(s, CMD_READ, reply, s.timeout, 100, [binary, done](const answer &a) {
+        readResult r;
+        if (!heard(a, r, "Wait read response")) {
+            done(r);
+            return;
+        }
+
+        if (binary) {
+            if (!a.reply.ok()) {
+                r.error = QString("Bad or incomplete read frame, %1 bytes").arg(a.data.size());
+                done(r);
+                return;
+            }
+            r.data = QByteArray(reinterpret_cast<const char *>(a.reply.payload().data()),
+                                (qsizetype) a.reply.payload().size());
+        }
+        else {
+            std::vector<uint8_t> data;
+            size_t line = 0;
+            if (!wireDumpParse(a.data.constData(), (size_t) a.data.size(), data, &line)) {
+                r.error = QString("Garbled read, line %1 of the dump").arg(line + 1);
+                done(r);
+                return;
+            }
+            r.data = QByteArray(reinterpret_cast<const char *>(data.data()), (qsizetype) data.size());
+        }
+        r.status = programmerResult::Done;
+        done(r);
+    });
+}
+
+// *****************************************************************************
+// Function     [ doBlankCheck ]
+// Description  [ All bytes as the device erases them, 0xff but for an 8748
+//                or 8749, which erases to 0x00
+//              ]
+// *****************************************************************************
+void
+programmer::doBlankCheck(const programmerSettings &s, const checkFunc &done)
+{
+    const uint8_t blank = device(s.devType).erased;
+    doRead(s, [blank, done](const readResult &read) {
+        checkResult r;
+        static_cast<readResult &>(r) = read;
+        r.blank = blank;
+        for (char c : r.data) {
+            if ((uint8_t) c != r.blank) {
+                r.fails++;
+            }
+        }
+        done(r);
+    });
+}
+
+// *****************************************************************************
+// Function     [ doWrite ]
+// Description  [ The burn is paced to the device, so it runs as a job,
+//                driving the port itself.
+//              ]
+// *****************************************************************************
+void
+programmer::doWrite(const programmerSettings &s, const std::shared_ptr<const hexImage> &image,
+                    const progressFunc &progress, const writeFunc &done)
+{
+    writeResult r;
+    if (image == nullptr || image->size() == 0) {
+        r.error = QString("No HEX data - please open a HEX file!");
+        done(r);
+        return;
+    }
+    job(s,
+        [this, s, image, progress, done](QSerialPort &serial) {
+            done(burn(serial, s, *image, progress));
+        },
+        [done](const answer &a) {
+            writeResult r;
+            heard(a, r, QString());
+            done(r);
+        });
+}
+
+// *****************************************************************************
+// Function     [ burn ]
+// Description  [ ]
+// *****************************************************************************
+writeResult
+programmer::burn(QSerialPort &serial, const programmerSettings &s,
+                 const hexImage &image, const progressFunc &progress)
+{
+    writeResult r;
+    deviceInfo info;
+    if (!deviceFind(s.devType.toStdString(), info)) {
+        r.error = QString("Can't write a %1").arg(s.devType);
+        return r;
+    }
+    // The spans go back to back from offset 0, so it is their bytes, not
+    // the image's extent, that have to fit
+    if (image.size() > info.capacity) {
+        r.error = QString("HEX file size is greater than %1 bytes!").arg(info.capacity);
+        return r;
+    }
+
+    const int32_t level = m_level;
+    burnSettings settings;
+    settings.binary = level >= 1;
+    settings.framed = level >= 3;
+    settings.window = level >= 2 ? s.window : 0;
+    settings.realTime = s.realTime;
+    settings.waitTimeout = s.timeout;
+    const hexSpanView spans = image.spans();
+    burnVisitor visit = { serial, settings, spans, progress, burnReport() };
+    deviceVisit(info.name, visit);
+
+    const burnReport &report = visit.report;
+    for (const std::string &line : report.pacing) {
+        r.pacing << QString::fromStdString(line);
+    }
+    r.bytes = report.bytes;
+    r.error = QString::fromStdString(report.error);
+    switch (report.status) {
+    case burnReport::Done:
+        r.status = programmerResult::Done;
+        break;
+    case burnReport::TimedOut:
+        r.status = programmerResult::TimedOut;
+        r.error += QString(" %1").arg(QTime::currentTime().toString());
+        break;
+    default:
+        r.status = programmerResult::Failed;
+        break;
+    }
+    return r;
+}
+
+// *****************************************************************************
+// Function     [ doVerify ]
+// Description  [ Read the device and diff it against the image ]
+// *****************************************************************************
+void
+programmer::doVerify(const programmerSettings &s, const std::shared_ptr<const hexImage> &image,
+                     const verifyFunc &done)
+{
+    if (image == nullptr || image->size() == 0) {
+        verifyResult r;
+        r.error = QString("No HEX data - please open a HEX file!");
+        done(r);
+        return;
+    }
+    doRead(s, [image, done](const readResult &read) {
+        verifyResult r;
+        static_cast<readResult &>(r) = read;
+        if (r.ok()) {
+            r.image = image;
+            hexDiffDump(*image, reinterpret_cast<const uint8_t *>(r.data.constData()), (size_t) r.data.size(),
+                        r.device, r.unread, r.report);
+        }
+        done(r);
+    });
+}
+
+// *****************************************************************************
+// Function     [ doPipeline ]
+// Description  [ Start the next step, or say the pipeline is Done. Each
+//                step's exchanges start afresh, as the hub does for every
+//                one, so nothing left over from the step before is taken
+//                for part of a reply.
+//              ]
+// *****************************************************************************
+void
+programmer::doPipeline(const std::shared_ptr<pipelineRun> &run)
+{
+    pipelineResult &r = run->result;
+    if (r.steps == run->pipeline.steps().size()) {
+        r.status = programmerResult::Done;
+        run->done(r);
+        return;
+    }
+    const programmerSettings &s = run->settings;
+    switch (run->pipeline.steps()[r.steps]) {
+    case programmerPipeline::Init:
+        doInit(s, [this, run](const initResult &step) {
+            run->result.init = step;
+            stepped(run, step);
+        });
+        break;
+    case programmerPipeline::Read:
+        doRead(s, [this, run](const readResult &step) {
+            run->result.read = step;
+            stepped(run, step);
+        });
+        break;
+    case programmerPipeline::BlankCheck:
+        doBlankCheck(s, [this, run](const checkResult &step) {
+            run->result.check = step;
+            stepped(run, step);
+        });
+        break;
+    case programmerPipeline::Write:
+        doWrite(s, run->image, run->progress, [this, run](const writeResult &step) {
+            run->result.write = step;
+            stepped(run, step);
+        });
+        break;
+    case programmerPipeline::Verify:
+        doVerify(s, run->image, [this, run](const verifyResult &step) {
+            run->result.verify = step;
+            stepped(run, step);
+        });
+        break;
+    }
+}
+
+// *****************************************************************************
+// Function     [ stepped ]
+// Description  [ A step is over; go on to the next unless it wasn't Done ]
+// *****************************************************************************
+void
+programmer::stepped(const std::shared_ptr<pipelineRun> &run, const programmerResult &last)
+{
+    pipelineResult &r = run->result;
+    r.steps++;
+    if (!last.ok()) {
+        r.status = last.status;
+        r.error = last.error;
+        run->done(r);
+        return;
+    }
+    doPipeline(run);
+}
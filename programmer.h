@@ -0,0 +1,295 @@
+#ifndef PROGRAMMER_H
+#define PROGRAMMER_H
+
+// *****************************************************************************
+// File         [ programmer.h ]
+// Description  [ The programmer's commands as typed async operations. init,
+//                read, blankCheck, write and verify each return at once with
+//                a QFuture of a result saying how it went, rather than
+//                strings for the window to pick apart. They queue, only so
+//                many deep, and run one after another. Each is a chain of
+//                the serialHub's exchanges, every one started from the
+//                reply to the one before, on the port the hub keeps open;
+//                only the paced burn drives the port itself, as a job. A
+//                pipeline runs several back to back, e.g. a write and its
+//                verify, without a trip through the GUI thread in between.
+//              ]
+// Author       [ Keith Sabine ]
+// *****************************************************************************
+
+#include <QByteArray>
+#include <QFuture>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QWaitCondition>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <vector>
+#include "deviceTraits.h"
+#include "hexDiff.h"
+#include "hexImage.h"
+#include "serialHub.h"
+#include "wireReply.h"
+
+class QSerialPort;
+
+// How many operations may wait, the one under way included
+const size_t programmerQueueDefault = 4;
+
+// *****************************************************************************
+// Class        [ programmerSettings ]
+// Description  [ The link and the device, as the window's controls have
+//                them. Timeouts are in mS.
+//              ]
+// *****************************************************************************
+struct programmerSettings
+{
+    QString                   portName;
+    int32_t                   baudRate = 115200;
+    int32_t                   flowControl = 0;
+    QString                   devType;
+    int32_t                   timeout = 10000;
+    int32_t                   window = 0;      // blocks in flight, given block writes
+    bool                      realTime = false;
+};
+
+// *****************************************************************************
+// Class        [ programmerResult ]
+// Description  [ How an operation went. Busy is one that was never queued,
+//                the queue being full.
+//              ]
+// *****************************************************************************
+struct programmerResult
+{
+    enum Status
+    {
+        Done,
+        Failed,
+        TimedOut,
+        Busy
+    };
+
+    Status                    status = Failed;
+    QString                   error;           // why, unless Done
+
+    bool                      ok() const { return status == Done; }
+};
+
+struct initResult : programmerResult
+{
+    int32_t                   divisor = -1;    // the PIC's baud rate generator
+    int32_t                   baudRate = 0;    // what that gives on its 20MHz clock
+    bool                      baudOk = false;  // within 5% of the rate asked for
+    bool                      typeSet = false;
+    int32_t                   level = 0;       // 1 binary, 2 block writes, 3 framed replies
+};
+
+struct readResult : programmerResult
+{
+    QByteArray                data;            // from address 0
+};
+
+struct checkResult : readResult
+{
+    uint8_t                   blank = 0xff;
+    size_t                    fails = 0;       // bytes that aren't
+};
+
+struct writeResult : programmerResult
+{
+    size_t                    bytes = 0;
+    QStringList               pacing;          // how the burn kept time
+};
+
+// *****************************************************************************
+// Class        [ verifyResult ]
+// Description  [ image is the image verified against, as it was handed in.
+//                device is what the device holds, where the write put each
+//                of the image's bytes, laid out as the image is from its
+//                base address, with the image's own bytes in its gaps.
+//                Bytes the read didn't reach are unread, not diffs.
+//              ]
+// *****************************************************************************
+struct verifyResult : readResult
+{
+    std::shared_ptr<const hexImage> image;
+    std::vector<uint8_t>      device;
+    std::vector<uint32_t>     unread;
+    hexDiffReport             report;
+
+    bool                      identical() const { return report.identical() && unread.empty(); }
+};
+
+// *****************************************************************************
+// Class        [ programmerPipeline ]
+// Description  [ Operations to run one after the other, stopping at the
+//                first that isn't Done. A verify that finds differences is
+//                still Done; whether it passed is in its result.
+//              ]
+// *****************************************************************************
+class programmerPipeline
+{
+public:
+    enum Step
+    {
+        Init,
+        Read,
+        BlankCheck,
+        Write,
+        Verify
+    };
+
+    programmerPipeline      & init() { m_Steps.push_back(Init); return *this; }
+    programmerPipeline      & read() { m_Steps.push_back(Read); return *this; }
+    programmerPipeline      & blankCheck() { m_Steps.push_back(BlankCheck); return *this; }
+    programmerPipeline      & write() { m_Steps.push_back(Write); return *this; }
+    programmerPipeline      & verify() { m_Steps.push_back(Verify); return *this; }
+
+    const std::vector<Step> & steps() const { return m_Steps; }
+
+private:
+    std::vector<Step>         m_Steps;
+};
+
+struct pipelineResult : programmerResult
+{
+    size_t                    steps = 0;       // run, the last one maybe not Done
+    initResult                init;
+    readResult                read;
+    checkResult               check;
+    writeResult               write;
+    verifyResult              verify;
+};
+
+// *****************************************************************************
+// Class        [ programmer ]
+// Description  [ The operations may be called from any thread. Their
+//                exchanges are answered in the serialHub's, where the next
+//                step of the operation is started. One operation finishes
+//                before the next starts, so nothing else gets onto the port
+//                part way through one. The queue is bounded: past its limit
+//                an operation comes back Busy at once, and a caller that
+//                would rather wait can do so in waitForRoom(). The protocol
+//                level init finds is kept for the operations after. A write
+//                or verify holds on to the image it is given, which can't
+//                change under it, so the caller may go on to load another.
+//              ]
+// *****************************************************************************
+class programmer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit                  programmer(serialHub *hub, QObject *parent = nullptr);
+                              ~programmer();
+
+    QFuture<initResult>       init(const programmerSettings &s);
+    QFuture<readResult>       read(const programmerSettings &s);
+    QFuture<checkResult>      blankCheck(const programmerSettings &s);
+    // Progress, 0 to 100, is the future's
+    QFuture<writeResult>      write(const programmerSettings &s, const std::shared_ptr<const hexImage> &image);
+    QFuture<verifyResult>     verify(const programmerSettings &s, const std::shared_ptr<const hexImage> &image);
+    QFuture<pipelineResult>   run(const programmerSettings &s, const programmerPipeline &pipeline,
+                                  const std::shared_ptr<const hexImage> &image = nullptr);
+    // The programmer says nothing back, and has to be init again after
+    QFuture<programmerResult> reset(const programmerSettings &s);
+
+    void                      setQueueLimit(size_t n);
+    // False if there is still no room after mS. Not from the hub's thread.
+    bool                      waitForRoom(int32_t mS);
+    int32_t                   level() const { return m_level.load(); }
+
+private slots:
+    void                      replied(int32_t id, const QByteArray &data);
+    void                      timedOut(int32_t id, bool written);
+    void                      failed(int32_t id, const QString &why);
+
+private:
+    typedef std::function<void(int32_t)>                  progressFunc;
+    typedef std::function<void(const initResult &)>       initFunc;
+    typedef std::function<void(const readResult &)>       readFunc;
+    typedef std::function<void(const checkResult &)>      checkFunc;
+    typedef std::function<void(const writeResult &)>      writeFunc;
+    typedef std::function<void(const verifyResult &)>     verifyFunc;
+    typedef std::function<void(const pipelineResult &)>   pipelineFunc;
+
+    // How an exchange went, as the hub said
+    struct answer
+    {
+        enum Kind
+        {
+            Replied,
+            TimedOut,
+            Failed
+        };
+
+        Kind                  kind = Failed;
+        QByteArray            data;
+        wireReply             reply;           // fed the data, if Replied
+        bool                  written = false; // the request had all gone out, if TimedOut
+        QString               why;             // if Failed
+    };
+    typedef std::function<void(const answer &)> answerFunc;
+
+    // An exchange, or a job, the hub has yet to answer
+    struct waiting
+    {
+        wireReply             reply;
+        answerFunc            then;
+    };
+
+    // A pipeline part way through, from one step to the next
+    struct pipelineRun
+    {
+        programmerSettings    settings;
+        programmerPipeline    pipeline;
+        std::shared_ptr<const hexImage> image;
+        progressFunc          progress;
+        pipelineFunc          done;
+        pipelineResult        result;
+    };
+
+    template <class Result, class Body>
+    QFuture<Result>           submit(const programmerSettings &s, Body body);
+    void                      start();
+    void                      release();
+
+    void                      ask(const programmerSettings &s, const QByteArray &request,
+                                  const wireReply &reply, int32_t timeout, int32_t gap,
+                                  const answerFunc &then);
+    void                      job(const programmerSettings &s, const serialJob &body,
+                                  const answerFunc &unopened);
+    void                      dispatch(int32_t id, answer &a);
+    static bool               heard(const answer &a, programmerResult &r, const QString &what);
+
+    void                      doInit(const programmerSettings &s, const initFunc &done);
+    void                      initLevel(const programmerSettings &s, const initResult &r, const initFunc &done);
+    void                      initType(const programmerSettings &s, const initResult &r, const initFunc &done);
+    void                      doRead(const programmerSettings &s, const readFunc &done);
+    void                      doBlankCheck(const programmerSettings &s, const checkFunc &done);
+    void                      doWrite(const programmerSettings &s, const std::shared_ptr<const hexImage> &image,
+                                      const progressFunc &progress, const writeFunc &done);
+    writeResult               burn(QSerialPort &serial, const programmerSettings &s,
+                                   const hexImage &image, const progressFunc &progress);
+    void                      doVerify(const programmerSettings &s, const std::shared_ptr<const hexImage> &image,
+                                       const verifyFunc &done);
+    void                      doPipeline(const std::shared_ptr<pipelineRun> &run);
+    void                      stepped(const std::shared_ptr<pipelineRun> &run, const programmerResult &last);
+
+    serialHub               * m_hub;
+    QMutex                    m_mutex;
+    QWaitCondition            m_room;
+    size_t                    m_limit;
+    size_t                    m_queued;        // waiting or under way
+    bool                      m_running;       // one is under way
+    std::deque<std::function<void()>> m_operations;   // waiting to start
+    std::map<int32_t, waiting> m_waiting;      // by the hub's id
+    std::atomic<int32_t>      m_level;
+};
+
+#endif /* PROGRAMMER_H */
@@ -0,0 +1,188 @@
+// *****************************************************************************
+// File         [ pulsePacer.cpp ]
+// Description  [ Implementation of the pulsePacer class ]
+// Author       [ Keith Sabine ]
+// *****************************************************************************
+
+#include "pulsePacer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <thread>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <time.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+#endif
+#endif
+
+// *****************************************************************************
+// Function     [ constructor ]
+// Description  [ Windows before 10 1803 has no high resolution timer, and
+//                falls back to sleep_until().
+//              ]
+// *****************************************************************************
+pulsePacer::pulsePacer(std::chrono::microseconds interval) :
+    m_Interval(std::chrono::duration_cast<clock::duration>(interval)),
+    m_Started(false),
+    m_Slips(0),
+    m_Total(0),
+    m_Timer(nullptr)
+{
+#if defined(_WIN32)
+    m_Timer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION,
+                                     TIMER_ALL_ACCESS);
+#endif
+}
+
+// *****************************************************************************
+// Function     [ destructor ]
+// Description  [ ]
+// *****************************************************************************
+pulsePacer::~pulsePacer()
+{
+#if defined(_WIN32)
+    if (m_Timer) {
+        CloseHandle(m_Timer);
+    }
+#endif
+}
+
+// *****************************************************************************
+// Function     [ start ]
+// Description  [ The first deadline is an interval from now ]
+// *****************************************************************************
+void
+pulsePacer::start()
+{
+    m_Last = clock::now();
+    m_Next = m_Last + m_Interval;
+    m_Started = true;
+}
+
+// *****************************************************************************
+// Function     [ reset ]
+// Description  [ ]
+// *****************************************************************************
+void
+pulsePacer::reset()
+{
+    m_Started = false;
+    m_Slips = 0;
+    m_Jitter.clear();
+    m_Total = 0;
+}
+
+// *****************************************************************************
+// Function     [ sleepUntil ]
+// Description  [ ]
+// *****************************************************************************
+void
+pulsePacer::sleepUntil(clock::time_point deadline)
+{
+#if defined(__linux__)
+    const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch()).count();
+    struct timespec ts;
+    ts.tv_sec = (time_t) (ns / 1000000000);
+    ts.tv_nsec = (long) (ns % 1000000000);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {
+    }
+#elif defined(_WIN32)
+    const auto left = deadline - clock::now();
+    if (left <= clock::duration::zero()) {
+        return;
+    }
+    if (m_Timer) {
+        // Relative, in 100nS units, but worked out from the deadline each
+        // time so it still doesn't drift
+        LARGE_INTEGER due;
+        due.QuadPart = -(LONGLONG) (std::chrono::duration_cast<std::chrono::nanoseconds>(left).count() / 100);
+        if (SetWaitableTimer(m_Timer, &due, 0, nullptr, nullptr, FALSE)) {
+            WaitForSingleObject(m_Timer, INFINITE);
+            return;
+        }
+    }
+    std::this_thread::sleep_until(deadline);
+#else
+    std::this_thread::sleep_until(deadline);
+#endif
+}
+
+// *****************************************************************************
+// Function     [ wait ]
+// Description  [ Deadlines step on by the interval from the last deadline,
+//                not from when the wait returned, so lateness on one byte
+//                comes out of the next interval instead of adding to the
+//                burn. More than a whole interval late, the bytes it
+//                missed aren't made up back to back, which would overrun
+//                the PIC; the deadlines restart from now.
+//              ]
+// *****************************************************************************
+void
+pulsePacer::wait()
+{
+    if (!m_Started) {
+        start();
+    }
+    sleepUntil(m_Next);
+
+    const clock::time_point now = clock::now();
+    const double actual = std::chrono::duration<double, std::micro>(now - m_Last).count();
+    const double target = std::chrono::duration<double, std::micro>(m_Interval).count();
+    m_Jitter.push_back((int32_t) std::lround(actual - target));
+    m_Total += actual;
+    m_Last = now;
+
+    m_Next += m_Interval;
+    if (now >= m_Next) {
+        m_Next = now + m_Interval;
+        m_Slips++;
+    }
+}
+
+// *****************************************************************************
+// Function     [ stats ]
+// Description  [ ]
+// *****************************************************************************
+pulseStats
+pulsePacer::stats() const
+{
+    pulseStats s;
+    s.intervals = m_Jitter.size();
+    s.target = std::chrono::duration<double, std::micro>(m_Interval).count();
+    s.slips = m_Slips;
+    s.elapsed = m_Total;
+    if (m_Jitter.empty()) {
+        return s;
+    }
+    s.mean = m_Total / m_Jitter.size();
+
+    std::vector<int32_t> error(m_Jitter.size());
+    std::transform(m_Jitter.begin(), m_Jitter.end(), error.begin(),
+                   [](int32_t j) { return j < 0 ? -j : j; });
+    const size_t k = (error.size() * 99 + 99) / 100 - 1;
+    std::nth_element(error.begin(), error.begin() + k, error.end());
+    s.p99Jitter = error[k];
+    s.maxJitter = *std::max_element(error.begin() + k, error.end());
+    return s;
+}
+
+// *****************************************************************************
+// Function     [ pulseStatsText ]
+// Description  [ ]
+// *****************************************************************************
+std::string
+pulseStatsText(const pulseStats &stats)
+{
+    char text[200];
+    std::snprintf(text, sizeof(text),
+                  "Paced %zu bytes at %.3fmS: mean %.3fmS, jitter p99 %.3fmS max %.3fmS, %zu slips, %.2fs",
+                  stats.intervals, stats.target / 1000, stats.mean / 1000,
+                  stats.p99Jitter / 1000, stats.maxJitter / 1000, stats.slips, stats.elapsed / 1e6);
+    return text;
+}
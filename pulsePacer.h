@@ -0,0 +1,88 @@
+#ifndef PULSEPACER_H
+#define PULSEPACER_H
+
+// *****************************************************************************
+// File         [ pulsePacer.h ]
+// Description  [ Paces the bytes of a burn to the programming pulse width.
+//                Sleeping for the pulse width before each byte adds the
+//                write, the flush and the scheduler's wake up latency on
+//                top of every byte, so a 2732 at 50mS runs well over its
+//                4096 x 50mS. Waiting for absolute deadlines, one pulse
+//                width apart, keeps all of that inside the interval, and
+//                the error can't build up from one byte to the next.
+//              ]
+// Author       [ Keith Sabine ]
+// *****************************************************************************
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// *****************************************************************************
+// Class        [ pulseStats ]
+// Description  [ How the intervals actually came out, in microseconds.
+//                Jitter is how far an interval was from the target, either
+//                way. A slip is a wait that found itself more than a whole
+//                interval late, after which the deadlines start again from
+//                then rather than sending the missed bytes back to back.
+//              ]
+// *****************************************************************************
+struct pulseStats
+{
+    size_t                    intervals = 0;
+    double                    target = 0;
+    double                    mean = 0;
+    double                    p99Jitter = 0;
+    double                    maxJitter = 0;
+    size_t                    slips = 0;
+    double                    elapsed = 0;      // all the intervals
+};
+
+// One line for the message area
+std::string                   pulseStatsText(const pulseStats &stats);
+
+// *****************************************************************************
+// Class        [ pulsePacer ]
+// Description  [ start() at the beginning of a pass, then wait() before
+//                each byte. On Linux the wait is clock_nanosleep() to an
+//                absolute CLOCK_MONOTONIC time, which is what the steady
+//                clock reads there; on Windows a high resolution waitable
+//                timer, and elsewhere sleep_until() on the steady clock.
+//                Statistics carry over start() so that the passes of a
+//                2708 make up one burn; reset() clears them. reserve()
+//                the intervals expected before the burn, so that keeping
+//                them doesn't allocate between bytes.
+//              ]
+// *****************************************************************************
+class pulsePacer
+{
+public:
+    typedef std::chrono::steady_clock clock;
+
+    explicit                  pulsePacer(std::chrono::microseconds interval);
+    ~pulsePacer();
+
+    void                      start();
+    void                      wait();
+    void                      reset();
+    void                      reserve(size_t intervals) { m_Jitter.reserve(intervals); }
+
+    pulseStats                stats() const;
+
+private:
+    void                      sleepUntil(clock::time_point deadline);
+
+    clock::duration           m_Interval;
+    clock::time_point         m_Next;
+    clock::time_point         m_Last;
+    bool                      m_Started;
+    size_t                    m_Slips;
+    // Each interval's error, in microseconds
+    std::vector<int32_t>      m_Jitter;
+    double                    m_Total;
+    void                    * m_Timer;
+};
+
+#endif /* PULSEPACER_H */
@@ -0,0 +1,302 @@
+// *****************************************************************************
+// File         [ realTime.cpp ]
+// Description  [ Implementation of the realTimeScope class ]
+// Author       [ Keith Sabine ]
+// *****************************************************************************
+
+#include "realTime.h"
+
+#include <cstring>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#endif
+
+// *****************************************************************************
+// Function     [ constructor ]
+// Description  [ ]
+// *****************************************************************************
+realTimeScope::realTimeScope(bool enable, int32_t core) :
+    m_Enabled(enable),
+    m_Raised(false),
+    m_Pinned(false),
+    m_Locked(false),
+    m_Policy(""),
+    m_Priority(0),
+    m_Core(-1),
+    m_OldPolicy(0),
+    m_OldPriority(0)
+{
+    if (m_Enabled) {
+        raise();
+        pin(core);
+        lock();
+    }
+}
+
+// *****************************************************************************
+// Function     [ destructor ]
+// Description  [ ]
+// *****************************************************************************
+realTimeScope::~realTimeScope()
+{
+#if defined(__linux__)
+    for (const auto &b : m_Buffers) {
+        munlock(b.first, b.second);
+    }
+    if (m_Locked) {
+        munlockall();
+    }
+    if (m_Pinned) {
+        pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t),
+                               reinterpret_cast<const cpu_set_t *>(m_OldMask.data()));
+    }
+    if (m_Raised) {
+        struct sched_param param;
+        std::memset(&param, 0, sizeof(param));
+        param.sched_priority = m_OldPriority;
+        pthread_setschedparam(pthread_self(), m_OldPolicy, &param);
+    }
+#elif defined(_WIN32)
+    for (const auto &b : m_Buffers) {
+        VirtualUnlock(const_cast<void *>(b.first), b.second);
+    }
+    if (m_Pinned) {
+        DWORD_PTR mask;
+        std::memcpy(&mask, m_OldMask.data(), sizeof(mask));
+        SetThreadAffinityMask(GetCurrentThread(), mask);
+    }
+    if (m_Raised) {
+        SetThreadPriority(GetCurrentThread(), m_OldPriority);
+    }
+#endif
+}
+
+// *****************************************************************************
+// Function     [ note ]
+// Description  [ ]
+// *****************************************************************************
+void
+realTimeScope::note(const char *what)
+{
+    if (!m_Refused.empty()) {
+        m_Refused += ", ";
+    }
+    m_Refused += what;
+}
+
+// *****************************************************************************
+// Function     [ raise ]
+// Description  [ A low real time priority is enough to beat every normal
+//                thread, and leaves the kernel's own real time threads
+//                (interrupts among them, on some kernels) above us.
+//              ]
+// *****************************************************************************
+void
+realTimeScope::raise()
+{
+#if defined(__linux__)
+    struct sched_param old;
+    int policy = 0;
+    if (pthread_getschedparam(pthread_self(), &policy, &old) != 0) {
+        note("priority unknown");
+        return;
+    }
+    m_OldPolicy = policy;
+    m_OldPriority = old.sched_priority;
+
+    static const int policies[] = { SCHED_FIFO, SCHED_RR };
+    static const char *names[] = { "SCHED_FIFO", "SCHED_RR" };
+    for (int i = 0; i < 2; ++i) {
+        struct sched_param param;
+        std::memset(&param, 0, sizeof(param));
+        param.sched_priority = sched_get_priority_min(policies[i]) + 9;
+        if (pthread_setschedparam(pthread_self(), policies[i], &param) == 0) {
+            m_Raised = true;
+            m_Policy = names[i];
+            m_Priority = param.sched_priority;
+            return;
+        }
+    }
+    note("no real time priority (needs CAP_SYS_NICE or an rtprio limit)");
+#elif defined(_WIN32)
+    m_OldPriority = GetThreadPriority(GetCurrentThread());
+    if (SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL)) {
+        m_Raised = true;
+        m_Policy = "time critical";
+        m_Priority = THREAD_PRIORITY_TIME_CRITICAL;
+        return;
+    }
+    note("no time critical priority");
+#else
+    note("no real time priority here");
+#endif
+}
+
+// *****************************************************************************
+// Function     [ pin ]
+// Description  [ The last core the thread may use is the one least likely
+//                to be taking interrupts.
+//              ]
+// *****************************************************************************
+void
+realTimeScope::pin(int32_t core)
+{
+#if defined(__linux__)
+    cpu_set_t old;
+    CPU_ZERO(&old);
+    if (pthread_getaffinity_np(pthread_self(), sizeof(old), &old) != 0) {
+        note("affinity unknown");
+        return;
+    }
+    if (core < 0) {
+        for (int32_t c = CPU_SETSIZE - 1; c >= 0; --c) {
+            if (CPU_ISSET(c, &old)) {
+                core = c;
+                break;
+            }
+        }
+    }
+    cpu_set_t one;
+    CPU_ZERO(&one);
+    if (core >= 0 && core < CPU_SETSIZE) {
+        CPU_SET(core, &one);
+    }
+    if (core < 0 || pthread_setaffinity_np(pthread_self(), sizeof(one), &one) != 0) {
+        note("not pinned");
+        return;
+    }
+    m_OldMask.assign(reinterpret_cast<const uint8_t *>(&old), reinterpret_cast<const uint8_t *>(&old) + sizeof(old));
+    m_Pinned = true;
+    m_Core = core;
+#elif defined(_WIN32)
+    DWORD_PTR process = 0;
+    DWORD_PTR system = 0;
+    if (!GetProcessAffinityMask(GetCurrentProcess(), &process, &system) || process == 0) {
+        note("affinity unknown");
+        return;
+    }
+    if (core < 0) {
+        for (int32_t c = (int32_t) sizeof(DWORD_PTR) * 8 - 1; c >= 0; --c) {
+            if (process & ((DWORD_PTR) 1 << c)) {
+                core = c;
+                break;
+            }
+        }
+    }
+    DWORD_PTR old = SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR) 1 << core);
+    if (old == 0) {
+        note("not pinned");
+        return;
+    }
+    m_OldMask.resize(sizeof(old));
+    std::memcpy(m_OldMask.data(), &old, sizeof(old));
+    m_Pinned = true;
+    m_Core = core;
+#else
+    (void) core;
+    note("not pinned here");
+#endif
+}
+
+// *****************************************************************************
+// Function     [ lock ]
+// Description  [ Only the pages there now. Locking future ones too would
+//                make any allocation past the limit fail, anywhere in the
+//                app. The top of the stack is touched so that it is there
+//                to be locked.
+//              ]
+// *****************************************************************************
+void
+realTimeScope::lock()
+{
+    volatile uint8_t stack[64 * 1024];
+    for (size_t i = 0; i < sizeof(stack); i += 4096) {
+        stack[i] = 0;
+    }
+#if defined(__linux__)
+    if (mlockall(MCL_CURRENT) == 0) {
+        m_Locked = true;
+        return;
+    }
+    note("memory not locked (needs CAP_IPC_LOCK or a memlock limit)");
+#elif defined(_WIN32)
+    // No mlockall(), the buffers are locked as they are prefaulted
+#else
+    note("memory not locked here");
+#endif
+}
+
+// *****************************************************************************
+// Function     [ prefault ]
+// Description  [ Read a byte of each page so it is in memory before the
+//                first deadline, then lock it, unless the whole process
+//                already is.
+//              ]
+// *****************************************************************************
+void
+realTimeScope::prefault(const void *data, size_t n)
+{
+    if (!m_Enabled || data == nullptr || n == 0) {
+        return;
+    }
+    const volatile uint8_t *p = static_cast<const volatile uint8_t *>(data);
+    uint8_t sum = 0;
+    for (size_t i = 0; i < n; i += 4096) {
+        sum = (uint8_t) (sum + p[i]);
+    }
+    sum = (uint8_t) (sum + p[n - 1]);
+    (void) sum;
+
+    if (m_Locked) {
+        return;
+    }
+#if defined(__linux__)
+    if (mlock(data, n) == 0) {
+        m_Buffers.push_back(std::make_pair(data, n));
+    }
+#elif defined(_WIN32)
+    if (VirtualLock(const_cast<void *>(data), n)) {
+        m_Buffers.push_back(std::make_pair(data, n));
+    }
+#endif
+}
+
+// *****************************************************************************
+// Function     [ text ]
+// Description  [ ]
+// *****************************************************************************
+std::string
+realTimeScope::text() const
+{
+    if (!m_Enabled) {
+        return "Normal scheduling";
+    }
+    std::string s = "Real time:";
+    if (m_Raised) {
+        s += " ";
+        s += m_Policy;
+        s += " " + std::to_string(m_Priority) + ",";
+    }
+    if (m_Pinned) {
+        s += " core " + std::to_string(m_Core) + ",";
+    }
+    if (m_Locked) {
+        s += " memory locked,";
+    }
+    else if (!m_Buffers.empty()) {
+        s += " " + std::to_string(m_Buffers.size()) + " buffers locked,";
+    }
+    if (!m_Refused.empty()) {
+        s += " " + m_Refused;
+    }
+    if (s.back() == ',') {
+        s.pop_back();
+    }
+    return s;
+}
@@ -0,0 +1,73 @@
+#ifndef REALTIME_H
+#define REALTIME_H
+
+// *****************************************************************************
+// File         [ realTime.h ]
+// Description  [ An opt in real time mode for the burn engine. On a
+//                loaded PC the wake up at each pulse deadline can come
+//                late enough to stretch the burn, or to let the PIC's
+//                buffer run dry. This raises the thread's priority, pins
+//                it to one core and keeps its memory resident while it
+//                burns. Each step needs privileges the user may not have,
+//                and anything refused is left as it was and said so.
+//              ]
+// Author       [ Keith Sabine ]
+// *****************************************************************************
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// *****************************************************************************
+// Class        [ realTimeScope ]
+// Description  [ For the life of the object, the calling thread runs
+//                SCHED_FIFO (or SCHED_RR) on Linux, at time critical
+//                priority on Windows, pinned to core (the last one if -1),
+//                with the process's pages locked. Everything is put back
+//                on destruction. Does nothing if not enabled, so the
+//                threads can always make one.
+//              ]
+// *****************************************************************************
+class realTimeScope
+{
+public:
+    explicit                  realTimeScope(bool enable, int32_t core = -1);
+    ~realTimeScope();
+
+    // Touch, and lock if possible, a buffer the burn will read from
+    void                      prefault(const void *data, size_t n);
+
+    bool                      enabled() const { return m_Enabled; }
+    bool                      raised() const { return m_Raised; }
+    bool                      pinned() const { return m_Pinned; }
+    bool                      locked() const { return m_Locked; }
+    size_t                    lockedBuffers() const { return m_Buffers.size(); }
+
+    // What was got, e.g. "Real time: SCHED_FIFO 10, core 3, memory locked"
+    std::string               text() const;
+
+private:
+    void                      raise();
+    void                      pin(int32_t core);
+    void                      lock();
+    void                      note(const char *what);
+
+    bool                      m_Enabled;
+    bool                      m_Raised;
+    bool                      m_Pinned;
+    bool                      m_Locked;
+    const char              * m_Policy;
+    int32_t                   m_Priority;
+    int32_t                   m_Core;
+    std::string               m_Refused;
+
+    // To put back
+    int32_t                   m_OldPolicy;
+    int32_t                   m_OldPriority;
+    std::vector<uint8_t>      m_OldMask;
+    std::vector<std::pair<const void *, size_t> > m_Buffers;
+};
+
+#endif /* REALTIME_H */
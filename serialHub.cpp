@@ -0,0 +1,242 @@
+// *****************************************************************************
+// File         [ serialHub.cpp ]
+// Description  [ Implementation of the serialHub class ]
+// Author       [ Keith Sabine ]
+// *****************************************************************************
+
+#include "serialHub.h"
+
+#include <QMutexLocker>
+#include <QTimer>
+#include <QtSerialPort/QSerialPort>
+
+// *****************************************************************************
+// Function     [ constructor ]
+// Description  [ ]
+// *****************************************************************************
+serialHub::serialHub(QObject *parent) :
+    QObject(parent),
+    m_nextId(0),
+    m_idleTimeout(serialIdleDefault)
+{
+}
+
+// *****************************************************************************
+// Function     [ destructor ]
+// Description  [ The ports and timers are our children ]
+// *****************************************************************************
+serialHub::~serialHub()
+{
+    qDeleteAll(m_lines);
+}
+
+// *****************************************************************************
+// Function     [ exchange ]
+// Description  [ Handed over to the hub's thread to start ]
+// *****************************************************************************
+int32_t
+serialHub::exchange(const serialExchange &x)
+{
+    QMutexLocker lock(&m_mutex);
+    m_pending.push_back(x);
+    m_pending.back().id = ++m_nextId;
+    QMetaObject::invokeMethod(this, "drain", Qt::QueuedConnection);
+    return m_nextId;
+}
+
+// *****************************************************************************
+// Function     [ drain ]
+// Description  [ Put the new exchanges on their ports' lines, making the
+//                port, here in the hub's thread, the first time it is used.
+//              ]
+// *****************************************************************************
+void
+serialHub::drain()
+{
+    std::deque<serialExchange> pending;
+    {
+        QMutexLocker lock(&m_mutex);
+        pending.swap(m_pending);
+    }
+
+    for (const serialExchange &x : pending) {
+        line *l = m_lines.value(x.portName, nullptr);
+        if (l == nullptr) {
+            l = new line;
+            l->port = new QSerialPort(this);
+            l->timer = new QTimer(this);
+            l->timer->setSingleShot(true);
+            l->idle = new QTimer(this);
+            l->idle->setSingleShot(true);
+            QObject::connect(l->port, &QSerialPort::readyRead, this, [this, l]() { readyRead(l); });
+            QObject::connect(l->port, &QSerialPort::bytesWritten, this, [l](qint64 n) { l->unwritten -= n; });
+            QObject::connect(l->port, &QSerialPort::errorOccurred, this,
+                             [this, l](QSerialPort::SerialPortError e) {
+                                 if (e != QSerialPort::NoError && e != QSerialPort::TimeoutError) {
+                                     portError(l);
+                                 }
+                             });
+            QObject::connect(l->timer, &QTimer::timeout, this, [this, l]() { expired(l); });
+            QObject::connect(l->idle, &QTimer::timeout, this, [l]() {
+                if (!l->busy && l->port->isOpen()) {
+                    l->port->close();
+                }
+            });
+            m_lines.insert(x.portName, l);
+        }
+        l->queue.push_back(x);
+        if (!l->busy) {
+            next(l);
+        }
+    }
+}
+
+// *****************************************************************************
+// Function     [ next ]
+// Description  [ Start the exchange at the front of the line, opening the
+//                port if it isn't already. A job runs there and then. The
+//                port is left open when there are none, until it has been
+//                idle for the idle timeout.
+//              ]
+// *****************************************************************************
+void
+serialHub::next(line *l)
+{
+    l->idle->stop();
+    while (!l->queue.empty()) {
+        serialExchange &x = l->queue.front();
+        if (!l->port->isOpen()) {
+            l->port->setPortName(x.portName);
+            if (!l->port->open(QIODevice::ReadWrite)) {
+                emit failed(x.id, tr("Can't open %1, error code %2")
+                    .arg(x.portName).arg(l->port->error()));
+                l->queue.pop_front();
+                continue;
+            }
+        }
+        if (l->port->baudRate() != x.baudRate) {
+            l->port->setBaudRate(x.baudRate);
+        }
+        if (l->port->flowControl() != (QSerialPort::FlowControl) x.flowControl) {
+            l->port->setFlowControl((QSerialPort::FlowControl) x.flowControl);
+        }
+
+        // Anything still arriving from before isn't this reply
+        l->port->readAll();
+        l->in.clear();
+
+        if (x.job) {
+            l->busy = true;
+            l->job = true;
+            x.job(*l->port);
+            l->job = false;
+            l->busy = false;
+            // Errors were the job's to report, but start afresh after one
+            if (l->port->error() != QSerialPort::NoError && l->port->error() != QSerialPort::TimeoutError) {
+                l->port->close();
+            }
+            l->port->clearError();
+            l->queue.pop_front();
+            continue;
+        }
+
+        x.reply.reset();
+        l->unwritten = x.request.size();
+        l->busy = true;
+        l->port->write(x.request);
+        l->timer->start(x.timeout);
+        return;
+    }
+    l->busy = false;
+    if (l->port->isOpen() && m_idleTimeout > 0) {
+        l->idle->start(m_idleTimeout);
+    }
+}
+
+// *****************************************************************************
+// Function     [ done ]
+// Description  [ ]
+// *****************************************************************************
+void
+serialHub::done(line *l)
+{
+    l->timer->stop();
+    l->queue.pop_front();
+    l->busy = false;
+    next(l);
+}
+
+// *****************************************************************************
+// Function     [ readyRead ]
+// Description  [ Over as soon as the reply is complete. Until then each part
+//                restarts the timer, for the gap; a reply that doesn't end
+//                as expected still ends when the line goes quiet.
+//              ]
+// *****************************************************************************
+void
+serialHub::readyRead(line *l)
+{
+    // A job reads for itself
+    if (l->job) {
+        return;
+    }
+    const QByteArray in = l->port->readAll();
+    if (!l->busy) {
+        return;
+    }
+    serialExchange &x = l->queue.front();
+    l->in += in;
+    if (x.reply.feed(in.constData(), (size_t) in.size())) {
+        emit replied(x.id, l->in);
+        done(l);
+        return;
+    }
+    l->timer->start(x.gap);
+}
+
+// *****************************************************************************
+// Function     [ expired ]
+// Description  [ Nothing in time, or the line has gone quiet part way into
+//                a reply, which is how replies used to end.
+//              ]
+// *****************************************************************************
+void
+serialHub::expired(line *l)
+{
+    if (!l->busy) {
+        return;
+    }
+    const serialExchange &x = l->queue.front();
+    if (l->in.isEmpty()) {
+        emit timedOut(x.id, l->unwritten <= 0);
+    }
+    else {
+        emit replied(x.id, l->in);
+    }
+    done(l);
+}
+
+// *****************************************************************************
+// Function     [ portError ]
+// Description  [ e.g. the programmer unplugged. The port is closed, and the
+//                next exchange on the line tries to open it again. A job
+//                sees the error itself, and the port is closed after it.
+//              ]
+// *****************************************************************************
+void
+serialHub::portError(line *l)
+{
+    if (l->job) {
+        return;
+    }
+    if (!l->busy) {
+        if (l->port->isOpen()) {
+            l->port->close();
+        }
+        return;
+    }
+    const serialExchange &x = l->queue.front();
+    emit failed(x.id, tr("%1: %2").arg(x.portName).arg(l->port->errorString()));
+    l->port->close();
+    done(l);
+}
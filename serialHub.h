@@ -0,0 +1,125 @@
+#ifndef SERIALHUB_H
+#define SERIALHUB_H
+
+// *****************************************************************************
+// File         [ serialHub.h ]
+// Description  [ The serial session: every command's I/O, on ports the
+//                hub opens once and keeps. A plain exchange, a request and
+//                its reply, is driven by the port's readyRead and
+//                bytesWritten notifications rather than by a thread
+//                blocking in waitForReadyRead(), and is over the moment its
+//                reply is complete. The programmer's operations are chains
+//                of these, each step started from the answer to the one
+//                before. Only the paced burn, which has to keep time with
+//                the device, runs as a job, blocking on the same open port.
+//                One hub, in one thread, does it all, one thing after
+//                another.
+//              ]
+// Author       [ Keith Sabine ]
+// *****************************************************************************
+
+#include <QByteArray>
+#include <QMap>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include "wireReply.h"
+
+class QSerialPort;
+class QTimer;
+
+// Work that drives the port itself, blocking, e.g. a paced burn
+typedef std::function<void(QSerialPort &port)> serialJob;
+
+// How long a port may sit unused before it is closed, in mS
+const int32_t                 serialIdleDefault = 60000;
+
+// *****************************************************************************
+// Class        [ serialExchange ]
+// Description  [ A request and how to tell its reply is all in. Timeouts
+//                are in mS: timeout for the reply to start, gap for each
+//                more part of one whose end wasn't recognised. Or, given
+//                a job, that is run with the port instead, in the hub's
+//                thread; nothing else on the port goes until it returns.
+//                The job says how it went through signals of its own.
+//              ]
+// *****************************************************************************
+struct serialExchange
+{
+    QString                   portName;
+    int32_t                   baudRate = 115200;
+    int32_t                   flowControl = 0;
+    QByteArray                request;
+    wireReply                 reply;
+    int32_t                   timeout = 10000;
+    int32_t                   gap = 100;
+    serialJob                 job;
+    int32_t                   id = 0;       // given by the hub
+};
+
+// *****************************************************************************
+// Class        [ serialHub ]
+// Description  [ Lives in a thread of its own; exchange() may be called
+//                from any. Exchanges on the same port go one after the
+//                other, in the order given. A port is opened for the first
+//                of them and then stays open, and configured, so a read,
+//                check, write and verify open it once, and an FTDI adapter
+//                doesn't see its modem lines toggled for each. Each port
+//                has its own line, and several can be open at once. One is
+//                only closed after an error, for the next exchange to open
+//                it afresh, or once it has been idle for the idle timeout,
+//                to let other programs have it.
+//              ]
+// *****************************************************************************
+class serialHub : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit                  serialHub(QObject *parent = nullptr);
+                              ~serialHub();
+
+    // Returns the id the signals for this exchange will carry
+    int32_t                   exchange(const serialExchange &x);
+    // 0 to keep ports open for good
+    void                      setIdleTimeout(int32_t mS) { m_idleTimeout = mS; }
+
+signals:
+    void                      replied(int32_t id, const QByteArray &data);
+    // written says whether the request had all gone out
+    void                      timedOut(int32_t id, bool written);
+    void                      failed(int32_t id, const QString &why);
+
+private slots:
+    void                      drain();
+
+private:
+    struct line
+    {
+        QSerialPort         * port = nullptr;
+        QTimer              * timer = nullptr;
+        QTimer              * idle = nullptr;
+        std::deque<serialExchange> queue;   // the front one is under way
+        QByteArray            in;
+        qint64                unwritten = 0;
+        bool                  busy = false;
+        bool                  job = false;  // a job has the port
+    };
+
+    void                      next(line *l);
+    void                      done(line *l);
+    void                      readyRead(line *l);
+    void                      expired(line *l);
+    void                      portError(line *l);
+
+    QMutex                    m_mutex;
+    std::deque<serialExchange> m_pending;   // given, not yet on a line
+    int32_t                   m_nextId;
+    std::atomic<int32_t>      m_idleTimeout;
+    QMap<QString, line *>     m_lines;
+};
+
+#endif /* SERIALHUB_H */
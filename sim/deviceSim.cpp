@@ -0,0 +1,303 @@
+// *****************************************************************************
+// File         [ deviceSim.cpp ]
+// Description  [ Implementation of the deviceSim class ]
+// Author       [ Keith Sabine ]
+// *****************************************************************************
+
+#include "deviceSim.h"
+#include "deviceTraits.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// The PIC runs at 20MHz, and reports its baud rate generator value
+static const double           picClock = 20.0e6;
+
+// *****************************************************************************
+// Function     [ constructor ]
+// Description  [ ]
+// *****************************************************************************
+deviceSim::deviceSim(int32_t baudRate, bool binaryCapable) :
+    m_BaudRate(baudRate),
+    m_BinaryCapable(binaryCapable),
+    m_Binary(false),
+    m_State(Command),
+    m_Erased(0xff),
+    m_Programmed(0),
+    m_SizeDigits(0),
+    m_Expected(0)
+{
+    setDevice('0');
+}
+
+// *****************************************************************************
+// Function     [ take ]
+// Description  [ ]
+// *****************************************************************************
+std::string
+deviceSim::take()
+{
+    std::string out;
+    out.swap(m_Out);
+    return out;
+}
+
+// *****************************************************************************
+// Function     [ idle ]
+// Description  [ Without this a garbled length leaves the model waiting
+//                for bytes the host will never send, and it takes the
+//                host's next tries as the rest of the frame.
+//              ]
+// *****************************************************************************
+void
+deviceSim::idle()
+{
+    if (m_State == BlockData && m_Decoder.state() != wireDecoder::Sync) {
+        m_Decoder.reset();
+    }
+}
+
+// *****************************************************************************
+// Function     [ setDevice ]
+// Description  [ Size and erased value from the device traits, a 2716 for
+//                a code it doesn't know
+//              ]
+// *****************************************************************************
+void
+deviceSim::setDevice(char type)
+{
+    deviceInfo device;
+    if (!deviceFindType(type, device)) {
+        deviceFindType('0' + DEV_2716, device);
+    }
+    m_Erased = device.erased;
+    m_Memory.assign(device.capacity, m_Erased);
+
+    char digits[16];
+    m_SizeDigits = (size_t) std::snprintf(digits, sizeof(digits), "%02x", (uint32_t) m_Memory.size());
+}
+
+// *****************************************************************************
+// Function     [ program ]
+// Description  [ An EPROM can only clear bits ]
+// *****************************************************************************
+void
+deviceSim::program(size_t address, uint8_t b)
+{
+    if (address < m_Memory.size()) {
+        uint8_t &cell = m_Memory[address];
+        cell = (m_Erased == 0xff) ? (uint8_t) (cell & b) : (uint8_t) (cell | b);
+    }
+}
+
+// *****************************************************************************
+// Function     [ block ]
+// Description  [ Program a good block where it says and ack it with the
+//                CRC of its data. A block sent again is programmed again,
+//                which leaves the same bits. A bad frame gets no ack, and
+//                the host sends it again. The empty block ends the write.
+//              ]
+// *****************************************************************************
+void
+deviceSim::block()
+{
+    const std::vector<uint8_t> &payload = m_Decoder.payload();
+    if (m_Decoder.ok() && m_Decoder.type() == wireFrame::Block && payload.size() >= wireBlockHeader) {
+        const size_t offset = payload[1] | ((size_t) payload[2] << 8);
+        const size_t size = payload.size() - wireBlockHeader;
+        for (size_t k = 0; k < size; ++k) {
+            program(offset + k, payload[wireBlockHeader + k]);
+        }
+        m_Programmed = std::max(m_Programmed, offset + size);
+
+        const uint16_t crc = wireCrc16(0xffff, payload.data() + wireBlockHeader, size);
+        const uint8_t ack[wireAckSize] = { payload[0], (uint8_t) crc, (uint8_t) (crc >> 8) };
+        wireEncodeFrame(wireFrame::Ack, ack, sizeof(ack), m_Out);
+        if (size == 0) {
+            m_State = Command;
+        }
+    }
+    m_Decoder.reset();
+}
+
+// *****************************************************************************
+// Function     [ sendStatus ]
+// Description  [ OK or CRC, as a Status frame once the host has asked for
+//                framing
+//              ]
+// *****************************************************************************
+void
+deviceSim::sendStatus(const char *status)
+{
+    if (m_Binary) {
+        wireEncodeFrame(wireFrame::Status, reinterpret_cast<const uint8_t *>(status),
+                        std::strlen(status), m_Out);
+    }
+    else {
+        m_Out += status;
+    }
+}
+
+// *****************************************************************************
+// Function     [ sendDump ]
+// Description  [ ]
+// *****************************************************************************
+void
+deviceSim::sendDump()
+{
+    if (m_Binary) {
+        wireEncodeFrame(wireFrame::Dump, m_Memory.data(), m_Memory.size(), m_Out);
+    }
+    else {
+        wireDumpText(m_Memory.data(), m_Memory.size(), m_Out);
+    }
+}
+
+// *****************************************************************************
+// Function     [ command ]
+// Description  [ ]
+// *****************************************************************************
+void
+deviceSim::command(char code)
+{
+    m_State = Command;
+    switch (code) {
+    case '1':
+    case '3':
+        sendDump();
+        break;
+    case '2':
+        m_Programmed = 0;
+        m_Field.clear();
+        if (m_Binary) {
+            m_Decoder.reset();
+            m_Decoder.setLimit(wireMaxPayload);
+            m_State = BinaryData;
+        }
+        else {
+            m_State = AsciiSize;
+        }
+        break;
+    case '5':
+        m_State = DeviceType;
+        break;
+    case '7':
+        if (m_Binary) {
+            m_Programmed = 0;
+            m_Decoder.reset();
+            m_Decoder.setLimit(wireBlockHeader + wireBlockSize);
+            m_State = BlockData;
+        }
+        break;
+    case '6':
+        // Older firmware ignores what it doesn't know
+        if (m_BinaryCapable) {
+            m_Binary = true;
+            m_Out += wireFramedReply;
+        }
+        break;
+    case '9':
+        m_Binary = false;
+        break;
+    default:
+        break;
+    }
+}
+
+// *****************************************************************************
+// Function     [ feed ]
+// Description  [ ]
+// *****************************************************************************
+void
+deviceSim::feed(const char *data, size_t n)
+{
+    size_t i = 0;
+    while (i < n) {
+        const char c = data[i];
+        switch (m_State) {
+        case Command:
+            if (c == 'U') {
+                char brg[16];
+                int32_t k = std::snprintf(brg, sizeof(brg), "%d",
+                                          (int32_t) (picClock / (4.0 * m_BaudRate) + 0.5) - 1);
+                m_Out.append(brg, k);
+            }
+            else if (c == '$') {
+                m_State = CommandCode;
+            }
+            else if (m_Binary && (uint8_t) c == wireStart) {
+                // The end block again, its ack having been lost
+                m_Decoder.reset();
+                m_Decoder.setLimit(wireBlockHeader + wireBlockSize);
+                m_State = BlockData;
+                break;
+            }
+            ++i;
+            break;
+
+        case CommandCode:
+            command(c);
+            ++i;
+            break;
+
+        case DeviceType:
+            setDevice(c);
+            sendStatus("OK");
+            m_State = Command;
+            ++i;
+            break;
+
+        case AsciiSize:
+            m_Field.push_back(c);
+            ++i;
+            if (m_Field.size() == m_SizeDigits) {
+                m_Expected = std::strtoul(m_Field.c_str(), nullptr, 16);
+                m_Field.clear();
+                m_State = m_Expected ? AsciiData : Command;
+                if (m_Expected == 0) {
+                    sendStatus("OK");
+                }
+            }
+            break;
+
+        case AsciiData: {
+            m_Field.push_back(c);
+            ++i;
+            if (m_Field.size() == 2) {
+                uint8_t b = 0;
+                hexDecodePair(m_Field.data(), b);
+                m_Field.clear();
+                program(m_Programmed++, b);
+                if (m_Programmed == m_Expected) {
+                    sendStatus("OK");
+                    m_State = Command;
+                }
+            }
+            break;
+        }
+
+        case BinaryData:
+            i += m_Decoder.feed(reinterpret_cast<const uint8_t *>(data) + i, n - i);
+            if (m_Decoder.done()) {
+                // Programming happens as bytes arrive; the CRC only says
+                // whether what arrived was what was sent
+                const std::vector<uint8_t> &payload = m_Decoder.payload();
+                for (size_t k = 0; k < payload.size(); ++k) {
+                    program(m_Programmed++, payload[k]);
+                }
+                sendStatus(m_Decoder.ok() && m_Decoder.type() == wireFrame::Data ? "OK" : "CRC");
+                m_State = Command;
+            }
+            break;
+
+        case BlockData:
+            i += m_Decoder.feed(reinterpret_cast<const uint8_t *>(data) + i, n - i);
+            if (m_Decoder.done()) {
+                block();
+            }
+            break;
+        }
+    }
+}
@@ -0,0 +1,81 @@
+#ifndef DEVICESIM_H
+#define DEVICESIM_H
+
+// *****************************************************************************
+// File         [ deviceSim.h ]
+// Description  [ A model of the PIC programmer's side of the serial link,
+//                for trying out the host without hardware and for measuring
+//                what each wire mode costs. It is fed the bytes the host
+//                sends and gives back the bytes the programmer would.
+//              ]
+// Author       [ Keith Sabine ]
+// *****************************************************************************
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "wireBlocks.h"
+
+// *****************************************************************************
+// Class        [ deviceSim ]
+// Description  [ Understands U (baud rate sync), $5 (device type), $6
+//                (binary framing, blocks and framed replies, unless built
+//                as older firmware), $1 and $3 (read), $2 (write), $7
+//                (block write) and $9 (reset). In ASCII the size
+//                sent with $2 is taken to have as many digits as the
+//                device size written the same way, as the firmware does.
+//              ]
+// *****************************************************************************
+class deviceSim
+{
+public:
+    explicit                  deviceSim(int32_t baudRate = 115200, bool binaryCapable = true);
+    ~deviceSim() {}
+
+    // Bytes from the host
+    void                      feed(const char *data, size_t n);
+    // Bytes for the host, since the last take()
+    std::string               take();
+    // The line has been quiet for a while; drop any frame part way in,
+    // as the firmware's inter byte timeout does
+    void                      idle();
+
+    bool                      binary() const { return m_Binary; }
+    const std::vector<uint8_t> &memory() const { return m_Memory; }
+    size_t                    programmed() const { return m_Programmed; }
+
+private:
+    enum State
+    {
+        Command,                 // waiting for U or $
+        CommandCode,             // had $, waiting for the code
+        DeviceType,              // had $5, waiting for the type digit
+        AsciiSize,               // had $2, reading the size
+        AsciiData,               // reading hex pairs
+        BinaryData,              // reading a data frame
+        BlockData                // reading block frames, up to the empty one
+    };
+
+    void                      command(char code);
+    void                      setDevice(char type);
+    void                      sendStatus(const char *status);
+    void                      sendDump();
+    void                      program(size_t address, uint8_t b);
+    void                      block();
+
+    int32_t                   m_BaudRate;
+    bool                      m_BinaryCapable;
+    bool                      m_Binary;
+    State                     m_State;
+    std::vector<uint8_t>      m_Memory;
+    uint8_t                   m_Erased;
+    size_t                    m_Programmed;
+    std::string               m_Field;
+    size_t                    m_SizeDigits;
+    size_t                    m_Expected;
+    wireDecoder               m_Decoder;
+    std::string               m_Out;
+};
+
+#endif /* DEVICESIM_H */
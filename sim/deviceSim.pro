@@ -0,0 +1,49 @@
+TEMPLATE = app
+TARGET = deviceSim
+DESTDIR = .
+
+CONFIG += console c++17
+CONFIG -= qt app_bundle
+
+CONFIG(release, debug|release) {
+    OBJECTS_DIR = release
+    DESTDIR = release
+}
+CONFIG(debug, debug|release) {
+    OBJECTS_DIR = debug
+    DESTDIR = debug
+}
+
+INCLUDEPATH += ..
+
+HEADERS += \
+    deviceSim.h \
+    ../burnEngine.h \
+    ../deviceTraits.h \
+    ../hexBits.h \
+    ../hexCodec.h \
+    ../hexDiff.h \
+    ../hexImage.h \
+    ../pulsePacer.h \
+    ../realTime.h \
+    ../spscRing.h \
+    ../wireBlocks.h \
+    ../wirePipeline.h \
+    ../wireProtocol.h \
+    ../wireReply.h \
+    ../wireStream.h
+
+SOURCES += \
+    deviceSim.cpp \
+    simMain.cpp \
+    ../deviceTraits.cpp \
+    ../hexCodec.cpp \
+    ../hexDiff.cpp \
+    ../hexImage.cpp \
+    ../pulsePacer.cpp \
+    ../realTime.cpp \
+    ../wireBlocks.cpp \
+    ../wirePipeline.cpp \
+    ../wireProtocol.cpp \
+    ../wireReply.cpp \
+    ../wireStream.cpp
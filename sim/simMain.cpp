@@ -0,0 +1,585 @@
+// *****************************************************************************
+// File         [ simMain.cpp ]
+// Description  [ The device simulator, run either way:
+//                  deviceSim --measure
+//                      wire bytes and times of a write and a read of each
+//                      device, ASCII against binary and block writes, at
+//                      each baud rate, and a block write over a bad line
+//                  deviceSim --pipeline [pulse uS, default 500]
+//                      a paced 2716 write through the producer thread and
+//                      the ring, with the I/O stage timed on its own
+//                  deviceSim --engine
+//                      burnEngine writes each known device, ASCII, binary
+//                      and block writes, with short pulses, and checks the
+//                      readback; then an image linked high, with a gap,
+//                      written, read back and verified as the GUI does
+//                  deviceSim --pty [baud] [--ascii]
+//                      serve a pseudo terminal the GUI can open as its
+//                      serial port; --ascii acts as older firmware
+//              ]
+// Author       [ Keith Sabine ]
+// *****************************************************************************
+
+#include "burnEngine.h"
+#include "deviceSim.h"
+#include "deviceTraits.h"
+#include "hexDiff.h"
+#include "pulsePacer.h"
+#include "wireBlocks.h"
+#include "wirePipeline.h"
+#include "wireReply.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+#define DEVICESIM_PTY 1
+#endif
+
+static const int32_t          baudRates[] = { 115200, 57600, 38400, 19200, 9600, 4800, 2400 };
+
+// *****************************************************************************
+// Function     [ hostWrite ]
+// Description  [ What a programming thread sends for $2, either way ]
+// *****************************************************************************
+static std::string
+hostWrite(const std::vector<uint8_t> &data, bool binary)
+{
+    std::string out = "$2";
+    wireEncoder wire(binary);
+    char edge[wireHeaderSize];
+    if (binary) {
+        out.append(edge, wire.begin(wireFrame::Data, (uint16_t) data.size(), edge));
+    }
+    else {
+        char size[16];
+        out.append(size, std::snprintf(size, sizeof(size), "%02x", (uint32_t) data.size()));
+    }
+    for (size_t i = 0; i < data.size(); ++i) {
+        char c[2];
+        out.append(c, wire.byte(data[i], c));
+    }
+    out.append(edge, wire.end(edge));
+    return out;
+}
+
+// *****************************************************************************
+// Class        [ simPort ]
+// Description  [ Enough of a serial port for wireSendBlocks, wired straight
+//                to the model. Every glitch'th byte sent is corrupted.
+//              ]
+// *****************************************************************************
+struct simPort
+{
+    deviceSim               & sim;
+    size_t                    glitch;
+    size_t                    sent;
+    size_t                    received;
+    std::string               pending;
+
+    simPort(deviceSim &s, size_t g = 0) : sim(s), glitch(g), sent(0), received(0) {}
+
+    int64_t write(const char *data, size_t n)
+    {
+        std::string line(data, n);
+        for (size_t i = 0; i < n; ++i) {
+            if (glitch && (sent + i + 1) % glitch == 0) {
+                line[i] ^= 0x10;
+            }
+        }
+        sent += n;
+        sim.feed(line.data(), n);
+        pending += sim.take();
+        return (int64_t) n;
+    }
+    bool flush()
+    {
+        return true;
+    }
+    bool waitForReadyRead(int32_t)
+    {
+        if (pending.empty()) {
+            sim.idle();
+            return false;
+        }
+        return true;
+    }
+    std::string readAll()
+    {
+        std::string in;
+        in.swap(pending);
+        received += in.size();
+        return in;
+    }
+};
+
+// *****************************************************************************
+// Function     [ hostBlocks ]
+// Description  [ A block write as the burn engine does it. Returns
+//                the bytes the host sent, or 0 if it failed. The acks come
+//                back while later blocks go out, so they cost no line time.
+//              ]
+// *****************************************************************************
+static size_t
+hostBlocks(deviceSim &sim, const std::vector<uint8_t> &data, size_t glitch, size_t *retransmits)
+{
+    simPort port(sim, glitch);
+    sim.feed("$7", 2);
+    wireBlockSender sender(data.data(), data.size());
+    if (!wireSendBlocks(port, sender, 0, [](int32_t) {})) {
+        return 0;
+    }
+    if (retransmits) {
+        *retransmits = sender.retransmits();
+    }
+    return 2 + port.sent;
+}
+
+// *****************************************************************************
+// Function     [ hostRead ]
+// Description  [ Decode a read response either way. False if it is bad. ]
+// *****************************************************************************
+static bool
+hostRead(const std::string &response, bool binary, std::vector<uint8_t> &data)
+{
+    if (binary) {
+        wireReply reply = wireReply::frame(wireFrame::Dump);
+        reply.feed(response.data(), response.size());
+        data = reply.payload();
+        return reply.ok();
+    }
+    return wireDumpParse(response.data(), response.size(), data);
+}
+
+// *****************************************************************************
+// Function     [ hostStatus ]
+// Description  [ The write's OK or CRC, framed once binary ]
+// *****************************************************************************
+static std::string
+hostStatus(const std::string &response, bool binary)
+{
+    if (binary) {
+        wireReply reply = wireReply::status();
+        reply.feed(response.data(), response.size());
+        return reply.text();
+    }
+    return response;
+}
+
+// *****************************************************************************
+// Function     [ measure ]
+// Description  [ Run a write then a read of random data through the model
+//                for each device, and count the bytes on the wire. Times
+//                are for 8N1 framing, ten bits a byte, and leave out the
+//                programming pulses, which are the same either way.
+//              ]
+// *****************************************************************************
+static int
+measure()
+{
+    struct device
+    {
+        char                  type;
+        const char          * name;
+    };
+    static const device devices[] = {
+        { '3', "2708" }, { '0', "2716" }, { '1', "2732" }, { '5', "8755" }
+    };
+
+    std::mt19937 rng(8);
+    int32_t failures = 0;
+    for (const device &d : devices) {
+        size_t wire[2][2];          // [binary][write, read]
+        size_t size = 0;
+        for (int32_t binary = 0; binary < 2; ++binary) {
+            deviceSim sim(115200, true);
+            sim.feed("U", 1);
+            const std::string type = std::string("$5") + d.type;
+            sim.feed(type.data(), type.size());
+            sim.take();
+            if (binary) {
+                sim.feed("$6", 2);
+                if (sim.take() != wireFramedReply) {
+                    failures++;
+                }
+            }
+
+            size = sim.memory().size();
+            std::vector<uint8_t> data(size);
+            for (size_t i = 0; i < size; ++i) {
+                data[i] = (uint8_t) rng();
+            }
+            const std::string request = hostWrite(data, binary != 0);
+            sim.feed(request.data(), request.size());
+            const std::string reply = sim.take();
+            wire[binary][0] = request.size() + reply.size();
+
+            sim.feed("$1", 2);
+            const std::string dump = sim.take();
+            wire[binary][1] = 2 + dump.size();
+
+            std::vector<uint8_t> back;
+            if (hostStatus(reply, binary != 0) != "OK" || !hostRead(dump, binary != 0, back) || back != data) {
+                std::printf("%s %s: readback doesn't match\n", d.name, binary ? "binary" : "ascii");
+                failures++;
+            }
+        }
+
+        // A block write, on a clean line
+        size_t blocks = 0;
+        {
+            deviceSim sim(115200, true);
+            const std::string type = std::string("$5") + d.type;
+            sim.feed(type.data(), type.size());
+            sim.feed("$6", 2);
+            sim.take();
+            std::vector<uint8_t> data(size);
+            for (size_t i = 0; i < size; ++i) {
+                data[i] = (uint8_t) rng();
+            }
+            blocks = hostBlocks(sim, data, 0, nullptr);
+            if (blocks == 0 || sim.memory() != data) {
+                std::printf("%s blocks: readback doesn't match\n", d.name);
+                failures++;
+            }
+        }
+
+        std::printf("%s, %zu bytes\n", d.name, size);
+        std::printf("  %-12s  %10s %10s  %10s %10s  %10s\n", "",
+                    "ascii wr", "ascii rd", "binary wr", "binary rd", "block wr");
+        std::printf("  %-12s  %10zu %10zu  %10zu %10zu  %10zu\n", "bytes",
+                    wire[0][0], wire[0][1], wire[1][0], wire[1][1], blocks);
+        for (int32_t baud : baudRates) {
+            char label[32];
+            std::snprintf(label, sizeof(label), "%d baud", baud);
+            std::printf("  %-12s  %9.2fs %9.2fs  %9.2fs %9.2fs  %9.2fs\n", label,
+                        wire[0][0] * 10.0 / baud, wire[0][1] * 10.0 / baud,
+                        wire[1][0] * 10.0 / baud, wire[1][1] * 10.0 / baud,
+                        blocks * 10.0 / baud);
+        }
+    }
+
+    // A 2732 over a line that corrupts one byte in every 500 sent
+    {
+        deviceSim sim(115200, true);
+        sim.feed("$51$6", 5);
+        sim.take();
+        std::vector<uint8_t> data(sim.memory().size());
+        for (size_t i = 0; i < data.size(); ++i) {
+            data[i] = (uint8_t) rng();
+        }
+        size_t retransmits = 0;
+        size_t bytes = hostBlocks(sim, data, 500, &retransmits);
+        bool good = bytes != 0 && sim.memory() == data;
+        std::printf("2732 block write, 1 byte in 500 corrupted: %s, %zu blocks sent again, %zu bytes\n",
+                    good ? "readback matches" : "FAILED", retransmits, bytes);
+        if (!good) {
+            failures++;
+        }
+    }
+    return failures == 0 ? 0 : 1;
+}
+
+// *****************************************************************************
+// Function     [ pipeline ]
+// Description  [ A paced 2716 write as the burn engine does it, the
+//                producer thread feeding the I/O stage through the ring,
+//                into the model, either way. Prints how the pacing and the
+//                I/O stage came out, and checks the programmed bytes.
+//              ]
+// *****************************************************************************
+static int
+pipeline(int32_t pulseWidth)
+{
+    std::mt19937 rng(8);
+    std::vector<uint8_t> data(2048);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = (uint8_t) rng();
+    }
+    hexImage image;
+    image.write(0, data.data(), data.size());
+
+    int32_t failures = 0;
+    for (int32_t binary = 0; binary < 2; ++binary) {
+        deviceSim sim(115200, true);
+        sim.feed("$50", 3);
+        if (binary) {
+            sim.feed("$6", 2);
+        }
+        sim.take();
+        simPort port(sim);
+
+        std::atomic<int32_t> percent(-1);
+        wirePipeline pipe("$2", hexSpanView(image), binary != 0);
+        pipe.start([&percent](int32_t pct) { percent = pct; });
+
+        // Every slice should be there; whole says if one wasn't
+        wireSlice slice;
+        bool whole = pipe.next(slice);
+        if (whole) {
+            pipe.send(port, slice);
+        }
+        pulsePacer pacer((std::chrono::microseconds(pulseWidth)));
+        pacer.reserve(pipe.count());
+        pacer.start();
+        for (size_t i = 0; whole && i < pipe.count(); ++i) {
+            whole = pipe.next(slice);
+            if (whole) {
+                pacer.wait();
+                pipe.send(port, slice);
+            }
+        }
+        whole = whole && pipe.next(slice);
+        if (whole) {
+            pipe.send(port, slice);
+        }
+        pipe.stop();
+
+        const bool good = whole && hostStatus(port.readAll(), binary != 0) == "OK" && sim.memory() == data && percent == 100;
+        std::printf("%s write, %zu bytes at %duS: %s\n  %s\n  %s\n",
+                    binary ? "binary" : "ascii", data.size(), pulseWidth,
+                    good ? "readback matches" : "FAILED",
+                    pulseStatsText(pacer.stats()).c_str(),
+                    wirePipelineText(pipe.stats()).c_str());
+        if (!good) {
+            failures++;
+        }
+    }
+    return failures == 0 ? 0 : 1;
+}
+
+// *****************************************************************************
+// Class        [ quick ]
+// Description  [ A device's traits, but with a short pulse and at most two
+//                passes, so that a run over them all doesn't take minutes
+//              ]
+// *****************************************************************************
+template <class Device>
+struct quick : Device
+{
+    static constexpr int64_t      pulseMicros = 100;
+    static constexpr int32_t      passes = Device::passes > 2 ? 2 : Device::passes;
+};
+
+// *****************************************************************************
+// Class        [ engineRun ]
+// Description  [ One device through burnEngine each way, into the model ]
+// *****************************************************************************
+struct engineRun
+{
+    std::mt19937            & rng;
+    int32_t                   failures;
+
+    explicit engineRun(std::mt19937 &r) : rng(r), failures(0) {}
+
+    template <class Device>
+    void operator()(Device)
+    {
+        static const char *modes[] = { "ascii", "binary", "blocks" };
+        for (int32_t mode = 0; mode < 3; ++mode) {
+            deviceSim sim(115200, true);
+            if (Device::type != 0) {
+                const char type[] = { '$', '5', Device::type };
+                sim.feed(type, sizeof(type));
+            }
+            if (mode > 0) {
+                sim.feed("$6", 2);
+            }
+            sim.take();
+
+            std::vector<uint8_t> data(Device::capacity);
+            for (size_t i = 0; i < data.size(); ++i) {
+                data[i] = (uint8_t) rng();
+            }
+            hexImage image;
+            image.write(0, data.data(), data.size());
+
+            burnSettings settings;
+            settings.binary = mode > 0;
+            settings.framed = mode > 0;
+            settings.window = mode == 2 ? (int32_t) wireWindowDefault : 0;
+            settings.waitTimeout = 1000;
+
+            simPort port(sim);
+            burnEngine<quick<Device> > engine(settings);
+            const burnReport report = engine.burn(port, hexSpanView(image), nullptr);
+
+            const bool good = report.status == burnReport::Done && sim.memory() == data;
+            std::printf("%-8s %-6s %d pass%s, %zu bytes: %s\n", Device::name, modes[mode],
+                        quick<Device>::passes, quick<Device>::passes > 1 ? "es" : "",
+                        report.bytes, good ? "readback matches" : report.error.c_str());
+            if (!good) {
+                failures++;
+            }
+        }
+    }
+};
+
+// *****************************************************************************
+// Function     [ engineLinked ]
+// Description  [ A 2716 image linked at 0xF800, with a gap, written then
+//                read back and verified. The write puts the spans back to
+//                back from offset 0, and verify has to look for them there.
+//              ]
+// *****************************************************************************
+static bool
+engineLinked(std::mt19937 &rng)
+{
+    deviceSim sim(115200, true);
+    const char type[] = { '$', '5', device2716::type };
+    sim.feed(type, sizeof(type));
+    sim.feed("$6", 2);
+    sim.take();
+
+    hexImage image;
+    std::vector<uint8_t> data(1024 + 700);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = (uint8_t) rng();
+    }
+    image.write(0xF800, data.data(), 1024);
+    image.write(0xFC40, data.data() + 1024, 700);
+
+    burnSettings settings;
+    settings.binary = true;
+    settings.framed = true;
+    settings.waitTimeout = 1000;
+    simPort port(sim);
+    burnEngine<quick<device2716> > engine(settings);
+    const burnReport report = engine.burn(port, hexSpanView(image), nullptr);
+
+    sim.feed("$1", 2);
+    std::vector<uint8_t> back;
+    const bool read = hostRead(sim.take(), true, back);
+
+    std::vector<uint8_t> device;
+    std::vector<uint32_t> unread;
+    hexDiffReport diff;
+    hexDiffDump(image, back.data(), back.size(), device, unread, diff);
+
+    const bool good = report.status == burnReport::Done && read && diff.identical() && unread.empty();
+    std::printf("2716     linked at 0xf800, gap at 0xfc00, %zu bytes: %s\n", report.bytes,
+                good ? "verify matches" : "FAILED");
+    return good;
+}
+
+// *****************************************************************************
+// Function     [ engine ]
+// Description  [ Every known device, through the one engine ]
+// *****************************************************************************
+static int
+engine()
+{
+    std::mt19937 rng(8);
+    engineRun run(rng);
+    for (const deviceInfo &device : deviceAll()) {
+        deviceVisit(device.name, run);
+    }
+    if (!engineLinked(rng)) {
+        run.failures++;
+    }
+    return run.failures == 0 ? 0 : 1;
+}
+
+#if defined(DEVICESIM_PTY)
+
+// *****************************************************************************
+// Function     [ servePty ]
+// Description  [ Answer the host over a pseudo terminal, holding each reply
+//                back for as long as it would take on a real line.
+//              ]
+// *****************************************************************************
+static int
+servePty(int32_t baudRate, bool binaryCapable)
+{
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) {
+        std::perror("posix_openpt");
+        return 1;
+    }
+    const char *name = ptsname(master);
+
+    // Keep the slave open and raw, so the host coming and going between
+    // transactions doesn't hang the line up or mangle the bytes
+    int slave = open(name, O_RDWR | O_NOCTTY);
+    if (slave < 0) {
+        std::perror(name);
+        return 1;
+    }
+    struct termios tio;
+    tcgetattr(slave, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(slave, TCSANOW, &tio);
+
+    std::printf("Simulating %s firmware at %d baud on %s\n",
+                binaryCapable ? "binary capable" : "ASCII only", baudRate, name);
+    std::fflush(stdout);
+
+    deviceSim sim(baudRate, binaryCapable);
+    char buffer[4096];
+    for (;;) {
+        ssize_t n = read(master, buffer, sizeof(buffer));
+        if (n <= 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            continue;
+        }
+        sim.feed(buffer, (size_t) n);
+        const std::string out = sim.take();
+        if (!out.empty()) {
+            std::this_thread::sleep_for(std::chrono::microseconds(out.size() * 10 * 1000000 / baudRate));
+            if (write(master, out.data(), out.size()) < 0) {
+                std::perror("write");
+                return 1;
+            }
+        }
+    }
+}
+
+#endif // DEVICESIM_PTY
+
+// *****************************************************************************
+// Function     [ main ]
+// Description  [ ]
+// *****************************************************************************
+int
+main(int argc, char *argv[])
+{
+    if (argc > 1 && std::strcmp(argv[1], "--measure") == 0) {
+        return measure();
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--pipeline") == 0) {
+        int32_t pulse = argc > 2 ? std::atoi(argv[2]) : 500;
+        return pipeline(pulse > 0 ? pulse : 500);
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--engine") == 0) {
+        return engine();
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--pty") == 0) {
+#if defined(DEVICESIM_PTY)
+        int32_t baudRate = 115200;
+        bool binaryCapable = true;
+        for (int i = 2; i < argc; ++i) {
+            if (std::strcmp(argv[i], "--ascii") == 0) {
+                binaryCapable = false;
+            }
+            else {
+                baudRate = std::atoi(argv[i]);
+            }
+        }
+        return servePty(baudRate > 0 ? baudRate : 115200, binaryCapable);
+#else
+        std::printf("--pty needs a POSIX system\n");
+        return 1;
+#endif
+    }
+    std::printf("Usage: deviceSim --measure | --pipeline [pulse uS] | --engine | --pty [baud] [--ascii]\n");
+    return 1;
+}
@@ -0,0 +1,84 @@
+#ifndef SPSCRING_H
+#define SPSCRING_H
+
+// *****************************************************************************
+// File         [ spscRing.h ]
+// Description  [ A fixed size ring of values passed from one thread to one
+//                other, without locks. Each side only ever writes its own
+//                index, and keeps a copy of the other's so that it needn't
+//                read the other side's cache line on every call.
+//              ]
+// Author       [ Keith Sabine ]
+// *****************************************************************************
+
+#include <atomic>
+#include <cstddef>
+
+// *****************************************************************************
+// Class        [ spscRing ]
+// Description  [ N slots, a power of two. push() is for the producer thread
+//                only and pop() for the consumer thread only; neither ever
+//                waits, they return false if the ring is full or empty.
+//                The indices count up for ever and are masked to a slot.
+//              ]
+// *****************************************************************************
+template <typename T, size_t N>
+class spscRing
+{
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "spscRing size must be a power of two");
+
+public:
+    spscRing() : m_Head(0), m_TailCache(0), m_Tail(0), m_HeadCache(0) {}
+
+    bool
+    push(const T &value)
+    {
+        const size_t tail = m_Tail.load(std::memory_order_relaxed);
+        if (tail - m_HeadCache == N) {
+            m_HeadCache = m_Head.load(std::memory_order_acquire);
+            if (tail - m_HeadCache == N) {
+                return false;
+            }
+        }
+        m_Slots[tail & (N - 1)] = value;
+        m_Tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool
+    pop(T &value)
+    {
+        const size_t head = m_Head.load(std::memory_order_relaxed);
+        if (head == m_TailCache) {
+            m_TailCache = m_Tail.load(std::memory_order_acquire);
+            if (head == m_TailCache) {
+                return false;
+            }
+        }
+        value = m_Slots[head & (N - 1)];
+        m_Head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // How many are queued, from either side; only a snapshot
+    size_t
+    size() const
+    {
+        const size_t head = m_Head.load(std::memory_order_acquire);
+        return m_Tail.load(std::memory_order_acquire) - head;
+    }
+
+    static size_t             capacity() { return N; }
+
+private:
+    // Consumer's line
+    alignas(64) std::atomic<size_t> m_Head;
+    size_t                    m_TailCache;
+    // Producer's line
+    alignas(64) std::atomic<size_t> m_Tail;
+    size_t                    m_HeadCache;
+
+    alignas(64) T             m_Slots[N];
+};
+
+#endif /* SPSCRING_H */
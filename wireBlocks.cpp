@@ -0,0 +1,164 @@
+// *****************************************************************************
+// File         [ wireBlocks.cpp ]
+// Description  [ Implementation of the wireBlockSender class ]
+// Author       [ Keith Sabine ]
+// *****************************************************************************
+
+#include "wireBlocks.h"
+
+#include <algorithm>
+
+// *****************************************************************************
+// Function     [ constructor ]
+// Description  [ Sequence numbers are a byte, so the window is kept well
+//                inside 256 blocks.
+//              ]
+// *****************************************************************************
+wireBlockSender::wireBlockSender(const uint8_t *data, size_t n, size_t window, size_t blockSize) :
+    m_Data(data, data + n),
+    m_Size(n),
+    m_Window(std::min(std::max<size_t>(window, 1), wireWindowMax)),
+    m_Base(0),
+    m_Sends(0),
+    m_Acknowledged(0),
+    m_Retransmits(0),
+    m_Failed(false)
+{
+    split(blockSize);
+}
+
+// *****************************************************************************
+// Function     [ constructor ]
+// Description  [ ]
+// *****************************************************************************
+wireBlockSender::wireBlockSender(const hexSpanView &spans, size_t window, size_t blockSize) :
+    m_Size(0),
+    m_Window(std::min(std::max<size_t>(window, 1), wireWindowMax)),
+    m_Base(0),
+    m_Sends(0),
+    m_Acknowledged(0),
+    m_Retransmits(0),
+    m_Failed(false)
+{
+    for (auto iter = spans.begin(); iter != spans.end(); ++iter) {
+        m_Data.insert(m_Data.end(), iter->data, iter->data + iter->size);
+    }
+    m_Size = m_Data.size();
+    split(blockSize);
+}
+
+// *****************************************************************************
+// Function     [ split ]
+// Description  [ The blocks, and the empty one that ends the write ]
+// *****************************************************************************
+void
+wireBlockSender::split(size_t blockSize)
+{
+    const uint8_t *data = m_Data.data();
+    blockSize = std::max<size_t>(blockSize, 1);
+    m_Blocks.reserve(m_Size / blockSize + 2);
+    for (size_t offset = 0; offset < m_Size; offset += blockSize) {
+        size_t size = std::min(blockSize, m_Size - offset);
+        block b = { offset, size, wireCrc16(0xffff, data + offset, size), Queued, 0, 0 };
+        m_Blocks.push_back(b);
+    }
+    block end = { m_Size, 0, 0xffff, Queued, 0, 0 };
+    m_Blocks.push_back(end);
+}
+
+// *****************************************************************************
+// Function     [ send ]
+// Description  [ ]
+// *****************************************************************************
+void
+wireBlockSender::send(std::string &out)
+{
+    const size_t last = m_Blocks.size() - 1;
+    const size_t limit = std::min(m_Base + m_Window, m_Blocks.size());
+    for (size_t i = m_Base; i < limit && !m_Failed; ++i) {
+        block &b = m_Blocks[i];
+        if (b.state != Queued) {
+            continue;
+        }
+        // The programmer leaves block mode on the end block
+        if (i == last && m_Base != last) {
+            break;
+        }
+        if (b.tries == wireBlockTries) {
+            m_Failed = true;
+            break;
+        }
+        if (b.tries) {
+            m_Retransmits++;
+        }
+        b.tries++;
+        b.sent = ++m_Sends;
+        b.state = InFlight;
+
+        wireEncoder encoder(true);
+        char edge[wireHeaderSize];
+        out.append(edge, encoder.begin(wireFrame::Block, (uint16_t) (wireBlockHeader + b.size), edge));
+        const uint8_t header[wireBlockHeader] = { (uint8_t) i, (uint8_t) b.offset, (uint8_t) (b.offset >> 8) };
+        for (size_t k = 0; k < wireBlockHeader + b.size; ++k) {
+            char c[2];
+            encoder.byte(k < wireBlockHeader ? header[k] : m_Data[b.offset + k - wireBlockHeader], c);
+            out.push_back(c[0]);
+        }
+        out.append(edge, encoder.end(edge));
+    }
+}
+
+// *****************************************************************************
+// Function     [ acknowledge ]
+// Description  [ An ack whose CRC isn't that of the block means the
+//                programmer took in something else, so it goes again.
+//              ]
+// *****************************************************************************
+bool
+wireBlockSender::acknowledge(const std::vector<uint8_t> &payload)
+{
+    if (payload.size() != wireAckSize) {
+        return false;
+    }
+    const size_t limit = std::min(m_Base + m_Window, m_Blocks.size());
+    size_t i = m_Base;
+    while (i < limit && (uint8_t) i != payload[0]) {
+        ++i;
+    }
+    if (i == limit || m_Blocks[i].state != InFlight) {
+        return false;
+    }
+
+    block &b = m_Blocks[i];
+    for (size_t k = m_Base; k < limit; ++k) {
+        if (m_Blocks[k].state == InFlight && m_Blocks[k].sent < b.sent) {
+            m_Blocks[k].state = Queued;
+        }
+    }
+    if (b.crc != (uint16_t) (payload[1] | (payload[2] << 8))) {
+        b.state = Queued;
+        return true;
+    }
+
+    b.state = Acked;
+    m_Acknowledged += b.size;
+    while (m_Base < m_Blocks.size() && m_Blocks[m_Base].state == Acked) {
+        m_Base++;
+    }
+    return true;
+}
+
+// *****************************************************************************
+// Function     [ expire ]
+// Description  [ ]
+// *****************************************************************************
+void
+wireBlockSender::expire()
+{
+    const size_t limit = std::min(m_Base + m_Window, m_Blocks.size());
+    for (size_t i = m_Base; i < limit; ++i) {
+        if (m_Blocks[i].state == InFlight) {
+            m_Blocks[i].state = Queued;
+        }
+    }
+}
@@ -0,0 +1,161 @@
+#ifndef WIREBLOCKS_H
+#define WIREBLOCKS_H
+
+// *****************************************************************************
+// File         [ wireBlocks.h ]
+// Description  [ Acknowledged block writes over the binary framing. The
+//                image goes out as numbered blocks, a window of them in
+//                flight at once, and the programmer answers each with the
+//                CRC of what it took in once it has programmed it. Only
+//                blocks that are lost or come back wrong are sent again,
+//                so a glitch on the line costs one block, not the burn.
+//              ]
+// Author       [ Keith Sabine ]
+// *****************************************************************************
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "hexImage.h"
+#include "wireProtocol.h"
+
+// What firmware that also takes blocks answers to CMD_PROT
+const char                    wireBlockReply[] = "B2";
+// And what firmware answers that then frames every reply it sends, the OK
+// and CRC as Status frames as well as the dump and the acks. Only U, which
+// comes before, stays as it was.
+const char                    wireFramedReply[] = "B3";
+
+// Block frame payload: sequence number, 16 bit offset, then the data.
+// Ack frame payload: sequence number, CRC-16 of the data programmed.
+const size_t                  wireBlockHeader = 3;
+const size_t                  wireAckSize = 3;
+
+// Small enough that a window of them fits in the PIC's RAM
+const size_t                  wireBlockSize = 64;
+const size_t                  wireWindowDefault = 4;
+const size_t                  wireWindowMax = 8;
+
+// Sends of one block before the write is given up
+const size_t                  wireBlockTries = 8;
+
+// *****************************************************************************
+// Class        [ wireBlockSender ]
+// Description  [ The host's side of one block write, without any I/O.
+//                It keeps its own copy of the bytes.
+//                send() gives the frames the window allows, acknowledge()
+//                takes each Ack frame and expire() says none came in time.
+//                The programmer works through blocks in the order they
+//                arrive, so an ack also means every block sent before the
+//                one acked, and still unacknowledged, was lost. The end
+//                is an empty block, sent once all the data is in.
+//              ]
+// *****************************************************************************
+class wireBlockSender
+{
+public:
+                              wireBlockSender(const uint8_t *data, size_t n,
+                                              size_t window = wireWindowDefault,
+                                              size_t blockSize = wireBlockSize);
+    // The occupied runs back to back, as the ASCII write sends them
+                              wireBlockSender(const hexSpanView &spans,
+                                              size_t window = wireWindowDefault,
+                                              size_t blockSize = wireBlockSize);
+
+    // Append the frames for every block the window now allows to out
+    void                      send(std::string &out);
+    // An Ack frame's payload. False if it matches nothing in flight.
+    bool                      acknowledge(const std::vector<uint8_t> &payload);
+    // Nothing heard in time, send what is in flight again
+    void                      expire();
+
+    bool                      done() const { return m_Base == m_Blocks.size(); }
+    bool                      failed() const { return m_Failed; }
+    size_t                    acknowledged() const { return m_Acknowledged; }
+    size_t                    size() const { return m_Size; }
+    size_t                    retransmits() const { return m_Retransmits; }
+
+private:
+    enum State
+    {
+        Queued,
+        InFlight,
+        Acked
+    };
+
+    struct block
+    {
+        size_t                offset;
+        size_t                size;
+        uint16_t              crc;
+        State                 state;
+        size_t                tries;
+        size_t                sent;     // when, counting sends
+    };
+
+    void                      split(size_t blockSize);
+
+    std::vector<uint8_t>      m_Data;
+    size_t                    m_Size;
+    size_t                    m_Window;
+    std::vector<block>        m_Blocks;
+    size_t                    m_Base;
+    size_t                    m_Sends;
+    size_t                    m_Acknowledged;
+    size_t                    m_Retransmits;
+    bool                      m_Failed;
+};
+
+// *****************************************************************************
+// Function     [ wireSendBlocks ]
+// Description  [ Run a block write over port, which need only have the
+//                write(), waitForReadyRead() and readAll() of a
+//                QSerialPort, so the simulator drives the same loop as the
+//                burn engine. Waits up to waitTimeout ms for each
+//                ack and calls progress with the percentage acknowledged.
+//              ]
+// *****************************************************************************
+template <class Port, class Progress>
+bool
+wireSendBlocks(Port &port, wireBlockSender &sender, int32_t waitTimeout, Progress progress)
+{
+    wireDecoder ack;
+    ack.setLimit(wireAckSize);
+    std::string out;
+    while (!sender.done() && !sender.failed()) {
+        out.clear();
+        sender.send(out);
+        if (!out.empty()) {
+            port.write(out.data(), out.size());
+        }
+
+        if (!port.waitForReadyRead(waitTimeout)) {
+            // A quiet line ends any frame part way in, at both ends, so a
+            // start byte found in the wrong place can't hold up the next
+            ack.reset();
+            sender.expire();
+            continue;
+        }
+
+        const auto in = port.readAll();
+        const uint8_t *p = reinterpret_cast<const uint8_t *>(in.data());
+        size_t n = (size_t) in.size();
+        while (n) {
+            size_t used = ack.feed(p, n);
+            p += used;
+            n -= used;
+            if (ack.done()) {
+                // A bad ack is as good as a lost one
+                if (ack.ok() && ack.type() == wireFrame::Ack) {
+                    sender.acknowledge(ack.payload());
+                }
+                ack.reset();
+            }
+        }
+        progress(sender.size() ? (int32_t) (sender.acknowledged() * 100 / sender.size()) : 100);
+    }
+    return sender.done();
+}
+
+#endif /* WIREBLOCKS_H */
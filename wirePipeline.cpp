@@ -0,0 +1,230 @@
+// *****************************************************************************
+// File         [ wirePipeline.cpp ]
+// Description  [ Implementation of the wirePipeline class ]
+// Author       [ Keith Sabine ]
+// *****************************************************************************
+
+#include "wirePipeline.h"
+
+#include <cstdio>
+
+// How long the producer sleeps when the ring is full, or once it has queued
+// everything, between looks at the progress. Well inside a pulse.
+static const std::chrono::microseconds s_Poll(500);
+
+// *****************************************************************************
+// Function     [ constructor ]
+// Description  [ ]
+// *****************************************************************************
+wirePipeline::wirePipeline(const char *command, const hexSpanView &spans,
+                           bool binary, int32_t passes) :
+    m_Command(command),
+    m_Spans(spans),
+    m_Binary(binary),
+    m_Passes(passes),
+    m_Count(0),
+    m_Percent(-1),
+    m_Encode(0),
+    m_HighWater(0),
+    m_Built(false),
+    m_Queued(false),
+    m_Stop(false),
+    m_Sent(0),
+    m_Slices(0),
+    m_Stalls(0),
+    m_WriteTotal(0),
+    m_WriteMax(0)
+{
+    for (auto iter = m_Spans.begin(); iter != m_Spans.end(); ++iter) {
+        m_Count += iter->size;
+    }
+}
+
+// *****************************************************************************
+// Function     [ destructor ]
+// Description  [ ]
+// *****************************************************************************
+wirePipeline::~wirePipeline()
+{
+    stop();
+}
+
+// *****************************************************************************
+// Function     [ start ]
+// Description  [ ]
+// *****************************************************************************
+void
+wirePipeline::start(const progressFunc &progress)
+{
+    m_Progress = progress;
+    m_Thread = std::thread(&wirePipeline::produce, this);
+}
+
+// *****************************************************************************
+// Function     [ stop ]
+// Description  [ ]
+// *****************************************************************************
+void
+wirePipeline::stop()
+{
+    m_Stop.store(true, std::memory_order_relaxed);
+    if (m_Thread.joinable()) {
+        m_Thread.join();
+    }
+}
+
+// *****************************************************************************
+// Function     [ stream ]
+// Description  [ ]
+// *****************************************************************************
+const wireStream &
+wirePipeline::stream()
+{
+    while (!m_Built.load(std::memory_order_acquire)) {
+        std::this_thread::sleep_for(s_Poll / 10);
+    }
+    return m_Stream;
+}
+
+// *****************************************************************************
+// Function     [ next ]
+// Description  [ Takes the next slice, waiting if the producer is behind.
+//                Once it is going it never should be, having the whole
+//                ring queued ahead. The wait sleeps, as a real time thread
+//                yielding would never let the producer in on a shared
+//                core. With nothing more to come it gives up.
+//              ]
+// *****************************************************************************
+bool
+wirePipeline::next(wireSlice &slice)
+{
+    if (!m_Ring.pop(slice)) {
+        m_Stalls++;
+        while (!m_Ring.pop(slice)) {
+            if (m_Queued.load(std::memory_order_acquire) || m_Stop.load(std::memory_order_relaxed)) {
+                // A last slice may have gone in before the flag was seen
+                if (!m_Ring.pop(slice)) {
+                    return false;
+                }
+                break;
+            }
+            std::this_thread::sleep_for(s_Poll / 10);
+        }
+    }
+    m_Slices++;
+    return true;
+}
+
+// *****************************************************************************
+// Function     [ stats ]
+// Description  [ ]
+// *****************************************************************************
+wirePipelineStats
+wirePipeline::stats() const
+{
+    wirePipelineStats s;
+    s.slices = m_Slices;
+    s.stalls = m_Stalls;
+    s.highWater = m_HighWater.load(std::memory_order_relaxed);
+    s.encode = m_Built.load(std::memory_order_acquire) ? m_Encode : 0;
+    s.writeMean = m_Slices ? m_WriteTotal / m_Slices : 0;
+    s.writeMax = m_WriteMax;
+    return s;
+}
+
+// *****************************************************************************
+// Function     [ report ]
+// Description  [ ]
+// *****************************************************************************
+void
+wirePipeline::report()
+{
+    const size_t total = m_Count * m_Passes;
+    if (total == 0 || !m_Progress) {
+        return;
+    }
+    const int32_t percent = (int32_t) (m_Sent.load(std::memory_order_relaxed) * 100 / total);
+    if (percent != m_Percent) {
+        m_Percent = percent;
+        m_Progress(percent);
+    }
+}
+
+// *****************************************************************************
+// Function     [ push ]
+// Description  [ Waits for room, reporting progress meanwhile. False if
+//                stopped.
+//              ]
+// *****************************************************************************
+bool
+wirePipeline::push(const wireSlice &slice)
+{
+    while (!m_Ring.push(slice)) {
+        if (m_Stop.load(std::memory_order_relaxed)) {
+            return false;
+        }
+        report();
+        std::this_thread::sleep_for(s_Poll);
+    }
+    const size_t queued = m_Ring.size();
+    if (queued > m_HighWater.load(std::memory_order_relaxed)) {
+        m_HighWater.store(queued, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+// *****************************************************************************
+// Function     [ produce ]
+// Description  [ The producer's thread. Once everything is queued it stays
+//                to report the progress until the I/O stage has sent it all.
+//              ]
+// *****************************************************************************
+void
+wirePipeline::produce()
+{
+    const clock::time_point begin = clock::now();
+    m_Stream.build(m_Command, m_Spans, m_Binary);
+    m_Encode = std::chrono::duration<double, std::micro>(clock::now() - begin).count();
+    m_Built.store(true, std::memory_order_release);
+
+    for (int32_t pass = 0; pass < m_Passes; ++pass) {
+        if (!push(wireSlice{ m_Stream.head(), (uint32_t) m_Stream.headSize(), wireSlice::Head })) {
+            return;
+        }
+        for (size_t i = 0; i < m_Stream.count(); ++i) {
+            if (!push(wireSlice{ m_Stream.byte(i), (uint32_t) m_Stream.width(), wireSlice::Byte })) {
+                return;
+            }
+        }
+        if (!push(wireSlice{ m_Stream.tail(), (uint32_t) m_Stream.tailSize(), wireSlice::Tail })) {
+            return;
+        }
+    }
+
+    m_Queued.store(true, std::memory_order_release);
+
+    const size_t total = m_Count * m_Passes;
+    while (m_Sent.load(std::memory_order_relaxed) < total) {
+        if (m_Stop.load(std::memory_order_relaxed)) {
+            return;
+        }
+        report();
+        std::this_thread::sleep_for(s_Poll);
+    }
+    report();
+}
+
+// *****************************************************************************
+// Function     [ wirePipelineText ]
+// Description  [ ]
+// *****************************************************************************
+std::string
+wirePipelineText(const wirePipelineStats &stats)
+{
+    char text[200];
+    std::snprintf(text, sizeof(text),
+                  "I/O stage %zu writes: mean %.3fmS, max %.3fmS, %zu stalls, ring high water %zu, encode %.3fmS",
+                  stats.slices, stats.writeMean / 1000, stats.writeMax / 1000,
+                  stats.stalls, stats.highWater, stats.encode / 1000);
+    return text;
+}
@@ -0,0 +1,158 @@
+#ifndef WIREPIPELINE_H
+#define WIREPIPELINE_H
+
+// *****************************************************************************
+// File         [ wirePipeline.h ]
+// Description  [ A write split in two. A producer thread turns the image
+//                into the wire stream, slices it up and keeps track of the
+//                progress; the programming thread is left as the I/O stage
+//                and only takes the next slice, waits for its deadline and
+//                writes it. The two meet in a lock free ring, so building
+//                the stream, the CRC and the progress signals never hold
+//                up a paced byte. The I/O stage times its own writes.
+//              ]
+// Author       [ Keith Sabine ]
+// *****************************************************************************
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+#include "hexImage.h"
+#include "spscRing.h"
+#include "wireStream.h"
+
+// *****************************************************************************
+// Class        [ wireSlice ]
+// Description  [ One write for the I/O stage: the head (cmd and size), one
+//                data byte, or the tail (the CRC, empty in ASCII). It points
+//                into the stream, which outlives it.
+//              ]
+// *****************************************************************************
+struct wireSlice
+{
+    enum Kind
+    {
+        Head,
+        Byte,
+        Tail
+    };
+
+    const char              * data;
+    uint32_t                  size;
+    Kind                      kind;
+};
+
+// *****************************************************************************
+// Class        [ wirePipelineStats ]
+// Description  [ In microseconds. A stall is the I/O stage finding the ring
+//                empty, i.e. waiting on the producer. The write times are
+//                the I/O stage on its own, from handing a slice to the port
+//                to the flush returning.
+//              ]
+// *****************************************************************************
+struct wirePipelineStats
+{
+    size_t                    slices = 0;
+    size_t                    stalls = 0;
+    size_t                    highWater = 0;    // most slices ever queued
+    double                    encode = 0;       // building the stream
+    double                    writeMean = 0;
+    double                    writeMax = 0;
+};
+
+// One line for the message area
+std::string                   wirePipelineText(const wirePipelineStats &stats);
+
+// *****************************************************************************
+// Class        [ wirePipeline ]
+// Description  [ passes is how many times the stream goes out, 100 for a
+//                2708, each pass a head, count() bytes and a tail. The
+//                stream is built once for all of them. progress is called
+//                on the producer's thread at each whole percent sent.
+//              ]
+// *****************************************************************************
+class wirePipeline
+{
+public:
+    typedef std::chrono::steady_clock clock;
+    typedef std::function<void(int32_t percent)> progressFunc;
+
+                              wirePipeline(const char *command, const hexSpanView &spans,
+                                           bool binary, int32_t passes = 1);
+                              ~wirePipeline();
+
+    void                      start(const progressFunc &progress);
+    // If the I/O stage gives up before the end
+    void                      stop();
+
+    // Waits for the producer to build it. Call it before going real time.
+    const wireStream        & stream();
+
+    // The I/O stage. next() is false once the producer is done or stopped
+    // with nothing left queued.
+    size_t                    count() const { return m_Count; }
+    bool                      next(wireSlice &slice);
+    template <class Port>
+    void                      send(Port &port, const wireSlice &slice);
+    wirePipelineStats         stats() const;
+
+private:
+    void                      produce();
+    bool                      push(const wireSlice &slice);
+    void                      report();
+
+    const char              * m_Command;
+    hexSpanView               m_Spans;
+    bool                      m_Binary;
+    int32_t                   m_Passes;
+    size_t                    m_Count;
+
+    // The producer's
+    progressFunc              m_Progress;
+    int32_t                   m_Percent;
+    wireStream                m_Stream;
+    double                    m_Encode;
+    std::atomic<size_t>       m_HighWater;
+    std::atomic<bool>         m_Built;
+    std::atomic<bool>         m_Queued;         // every slice pushed
+    std::atomic<bool>         m_Stop;
+    std::thread               m_Thread;
+
+    spscRing<wireSlice, 256>  m_Ring;
+
+    // The I/O stage's; the producer reads m_Sent for the progress
+    std::atomic<size_t>       m_Sent;
+    size_t                    m_Slices;
+    size_t                    m_Stalls;
+    double                    m_WriteTotal;
+    double                    m_WriteMax;
+};
+
+// *****************************************************************************
+// Function     [ send ]
+// Description  [ Port need only have the write() and flush() of a
+//                QSerialPort.
+//              ]
+// *****************************************************************************
+template <class Port>
+void
+wirePipeline::send(Port &port, const wireSlice &slice)
+{
+    const clock::time_point begin = clock::now();
+    port.write(slice.data, slice.size);
+    port.flush();
+    const double took = std::chrono::duration<double, std::micro>(clock::now() - begin).count();
+    m_WriteTotal += took;
+    if (took > m_WriteMax) {
+        m_WriteMax = took;
+    }
+    if (slice.kind == wireSlice::Byte) {
+        m_Sent.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+#endif /* WIREPIPELINE_H */
@@ -0,0 +1,244 @@
+// *****************************************************************************
+// File         [ wireProtocol.cpp ]
+// Description  [ Implementation of the binary serial framing ]
+// Author       [ Keith Sabine ]
+// *****************************************************************************
+
+#include "wireProtocol.h"
+
+#include <algorithm>
+#include <cstdio>
+
+const wireTables g_WireTables;
+
+// *****************************************************************************
+// Function     [ constructor ]
+// Description  [ ]
+// *****************************************************************************
+wireTables::wireTables()
+{
+    for (uint32_t b = 0; b < 256; ++b) {
+        uint16_t c = (uint16_t) (b << 8);
+        for (int32_t k = 0; k < 8; ++k) {
+            c = (c & 0x8000) ? (uint16_t) ((c << 1) ^ 0x1021) : (uint16_t) (c << 1);
+        }
+        crc[b] = c;
+    }
+}
+
+// *****************************************************************************
+// Function     [ wireCrc16 ]
+// Description  [ ]
+// *****************************************************************************
+uint16_t
+wireCrc16(uint16_t crc, const uint8_t *data, size_t n)
+{
+    for (size_t i = 0; i < n; ++i) {
+        crc = wireCrc16(crc, data[i]);
+    }
+    return crc;
+}
+
+// *****************************************************************************
+// Function     [ begin ]
+// Description  [ The CRC starts with the type and length ]
+// *****************************************************************************
+size_t
+wireEncoder::begin(wireFrame::Type type, uint16_t length, char *out)
+{
+    if (!m_Binary) {
+        return 0;
+    }
+    const uint8_t header[wireHeaderSize] = { wireStart, (uint8_t) type,
+                                             (uint8_t) length, (uint8_t) (length >> 8) };
+    m_Crc = wireCrc16(0xffff, header + 1, wireHeaderSize - 1);
+    std::copy(header, header + wireHeaderSize, out);
+    return wireHeaderSize;
+}
+
+// *****************************************************************************
+// Function     [ end ]
+// Description  [ ]
+// *****************************************************************************
+size_t
+wireEncoder::end(char *out)
+{
+    if (!m_Binary) {
+        return 0;
+    }
+    out[0] = (char) (uint8_t) m_Crc;
+    out[1] = (char) (uint8_t) (m_Crc >> 8);
+    return wireTrailerSize;
+}
+
+// *****************************************************************************
+// Function     [ wireEncodeFrame ]
+// Description  [ ]
+// *****************************************************************************
+void
+wireEncodeFrame(wireFrame::Type type, const uint8_t *data, size_t n, std::string &out)
+{
+    wireEncoder encoder(true);
+    char edge[wireHeaderSize];
+    out.reserve(out.size() + wireHeaderSize + n + wireTrailerSize);
+    out.append(edge, encoder.begin(type, (uint16_t) n, edge));
+    for (size_t i = 0; i < n; ++i) {
+        char c[2];
+        encoder.byte(data[i], c);
+        out.push_back(c[0]);
+    }
+    out.append(edge, encoder.end(edge));
+}
+
+// *****************************************************************************
+// Function     [ reset ]
+// Description  [ ]
+// *****************************************************************************
+void
+wireDecoder::reset()
+{
+    m_State = Sync;
+    m_Have = 0;
+    m_Length = 0;
+    m_Skipped = 0;
+    m_Payload.clear();
+}
+
+// *****************************************************************************
+// Function     [ feed ]
+// Description  [ ]
+// *****************************************************************************
+size_t
+wireDecoder::feed(const uint8_t *data, size_t n)
+{
+    size_t i = 0;
+    while (i < n && !done()) {
+        switch (m_State) {
+        case Sync:
+            if (data[i++] == wireStart) {
+                m_State = Header;
+                m_Have = 0;
+            }
+            else {
+                m_Skipped++;
+            }
+            break;
+
+        case Header:
+            m_Header[m_Have++] = data[i++];
+            if (m_Have == sizeof(m_Header)) {
+                m_Length = m_Header[1] | ((size_t) m_Header[2] << 8);
+                if (m_Length > m_Limit) {
+                    m_State = Error;
+                    break;
+                }
+                m_Payload.clear();
+                m_Payload.reserve(m_Length);
+                m_Have = 0;
+                m_State = m_Length ? Payload : Trailer;
+            }
+            break;
+
+        case Payload: {
+            size_t take = std::min(n - i, m_Length - m_Payload.size());
+            m_Payload.insert(m_Payload.end(), data + i, data + i + take);
+            i += take;
+            if (m_Payload.size() == m_Length) {
+                m_State = Trailer;
+            }
+            break;
+        }
+
+        case Trailer:
+            m_Trailer[m_Have++] = data[i++];
+            if (m_Have == sizeof(m_Trailer)) {
+                uint16_t crc = wireCrc16(0xffff, m_Header, sizeof(m_Header));
+                crc = wireCrc16(crc, m_Payload.data(), m_Payload.size());
+                bool match = crc == (m_Trailer[0] | (m_Trailer[1] << 8));
+                m_State = match ? Done : Error;
+            }
+            break;
+
+        default:
+            break;
+        }
+    }
+    return i;
+}
+
+// *****************************************************************************
+// Function     [ wireDumpText ]
+// Description  [ ]
+// *****************************************************************************
+void
+wireDumpText(const uint8_t *data, size_t n, std::string &out)
+{
+    out.reserve(out.size() + (n + 15) / 16 * 54);
+    for (size_t address = 0; address < n; address += 16) {
+        char line[64];
+        int32_t k = std::snprintf(line, sizeof(line), "%04x:", (uint32_t) address);
+        size_t count = std::min<size_t>(16, n - address);
+        for (size_t i = 0; i < count; ++i) {
+            line[k++] = ' ';
+            hexEncodeByte(data[address + i], line + k);
+            k += 2;
+        }
+        line[k++] = '\n';
+        out.append(line, k);
+    }
+}
+
+// *****************************************************************************
+// Function     [ wireDumpParse ]
+// Description  [ Lines of 'aaaa:' and up to 16 ' xx', each ending in a
+//                newline, maybe after a carriage return. Only the last may
+//                be short.
+//              ]
+// *****************************************************************************
+bool
+wireDumpParse(const char *text, size_t n, std::vector<uint8_t> &out, size_t *badLine)
+{
+    out.clear();
+    out.reserve(n / 3);
+    size_t line = 0;
+    size_t j = 0;
+    bool shortLine = false;
+    while (j < n) {
+        // The address, as many hex digits as it takes
+        uint32_t address = 0;
+        size_t digits = 0;
+        for (; j < n && text[j] != ':'; ++j, ++digits) {
+            const uint8_t nibble = g_HexTables.nibble[(uint8_t) text[j]];
+            if (nibble >= 16 || digits == 8) {
+                break;
+            }
+            address = (address << 4) | nibble;
+        }
+        bool good = !shortLine && digits > 0 && j < n && text[j] == ':' && address == out.size();
+        ++j;
+
+        // Then the bytes, to the end of the line
+        size_t count = 0;
+        while (good && j < n && text[j] == ' ') {
+            uint8_t b = 0;
+            good = count < 16 && j + 3 <= n && hexDecodePair(text + j + 1, b);
+            out.push_back(b);
+            ++count;
+            j += 3;
+        }
+        if (good && j < n && text[j] == '\r') {
+            ++j;
+        }
+        if (!good || count == 0 || j >= n || text[j] != '\n') {
+            out.resize(out.size() - count);
+            if (badLine) {
+                *badLine = line;
+            }
+            return false;
+        }
+        ++j;
+        shortLine = count < 16;
+        ++line;
+    }
+    return true;
+}
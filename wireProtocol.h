@@ -0,0 +1,188 @@
+#ifndef WIREPROTOCOL_H
+#define WIREPROTOCOL_H
+
+// *****************************************************************************
+// File         [ wireProtocol.h ]
+// Description  [ The binary framing used on the serial link once the
+//                programmer has said, at init, that it understands it.
+//                A frame is a start byte, a type, a little endian 16 bit
+//                length, that many raw bytes and a CRC-16 of everything
+//                after the start byte, so data crosses the UART at one
+//                byte a byte instead of two hex characters (or three and
+//                an address per 16, for a read dump). Firmware without it
+//                keeps to the original ASCII, and nothing here touches Qt,
+//                so the device simulator shares it.
+//              ]
+// Author       [ Keith Sabine ]
+// *****************************************************************************
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "hexCodec.h"
+
+// What binary capable firmware answers to CMD_PROT
+const char                    wireBinaryReply[] = "B1";
+
+const uint8_t                 wireStart = 0xa5;
+// Start byte, type and length
+const size_t                  wireHeaderSize = 4;
+// CRC-16, little endian
+const size_t                  wireTrailerSize = 2;
+const size_t                  wireMaxPayload = 0xffff;
+// Longest Status frame payload
+const size_t                  wireStatusMax = 16;
+
+// *****************************************************************************
+// Class        [ wireFrame ]
+// Description  [ Frame types ]
+// *****************************************************************************
+struct wireFrame
+{
+    enum Type
+    {
+        Data = 'D',              // host to programmer, bytes to program
+        Dump = 'R',              // programmer to host, bytes read back
+        Block = 'K',             // host to programmer, one numbered block
+        Ack = 'A',               // programmer to host, a block programmed
+        Status = 'S'             // programmer to host, a short reply: OK, CRC
+    };
+};
+
+// *****************************************************************************
+// Class        [ wireTables ]
+// Description  [ The CRC-16/CCITT (polynomial 0x1021, from 0xffff) table.
+//                The PIC does the same CRC a bit at a time.
+//              ]
+// *****************************************************************************
+struct wireTables
+{
+    uint16_t                  crc[256];
+
+    wireTables();
+};
+
+extern const wireTables       g_WireTables;
+
+inline uint16_t
+wireCrc16(uint16_t crc, uint8_t b)
+{
+    return (uint16_t) ((crc << 8) ^ g_WireTables.crc[(uint8_t) ((crc >> 8) ^ b)]);
+}
+
+uint16_t                      wireCrc16(uint16_t crc, const uint8_t *data, size_t n);
+
+// *****************************************************************************
+// Class        [ wireEncoder ]
+// Description  [ Writes one transfer's data either way, so a programming
+//                loop can pace out its bytes without caring which. In
+//                ASCII begin() and end() give nothing and the caller
+//                sends the size as it always has.
+//              ]
+// *****************************************************************************
+class wireEncoder
+{
+public:
+    explicit                  wireEncoder(bool binary) : m_Binary(binary), m_Crc(0xffff) {}
+
+    bool                      binary() const { return m_Binary; }
+
+    // The frame header for length bytes of type. Returns its size.
+    size_t                    begin(wireFrame::Type type, uint16_t length, char *out);
+
+    // One data byte, as itself or as two hex characters. Returns how many.
+    size_t                    byte(uint8_t b, char *out)
+    {
+        if (m_Binary) {
+            m_Crc = wireCrc16(m_Crc, b);
+            out[0] = (char) b;
+            return 1;
+        }
+        hexEncodeByte(b, out);
+        return 2;
+    }
+
+    // The frame trailer. Returns its size.
+    size_t                    end(char *out);
+
+private:
+    bool                      m_Binary;
+    uint16_t                  m_Crc;
+};
+
+// Append a whole frame of type carrying [data, data+n) to out
+void                          wireEncodeFrame(wireFrame::Type type, const uint8_t *data, size_t n,
+                                              std::string &out);
+
+// *****************************************************************************
+// Class        [ wireDecoder ]
+// Description  [ Picks one frame out of bytes fed in as they arrive. Bytes
+//                before the start byte are skipped. Once done(), ok() says
+//                whether the CRC matched; reset() for the next frame.
+//              ]
+// *****************************************************************************
+class wireDecoder
+{
+public:
+    enum State
+    {
+        Sync,
+        Header,
+        Payload,
+        Trailer,
+        Done,
+        Error
+    };
+
+    wireDecoder() : m_Limit(wireMaxPayload) { reset(); }
+
+    void                      reset();
+    // Longer frames are errors, so a garbled length can't swallow the
+    // frames after it
+    void                      setLimit(size_t limit) { m_Limit = limit; }
+    // Returns how many bytes were used; feeding stops at the end of a frame
+    size_t                    feed(const uint8_t *data, size_t n);
+
+    State                     state() const { return m_State; }
+    bool                      done() const { return m_State == Done || m_State == Error; }
+    bool                      ok() const { return m_State == Done; }
+    uint8_t                   type() const { return m_Header[0]; }
+    const std::vector<uint8_t> &payload() const { return m_Payload; }
+    size_t                    skipped() const { return m_Skipped; }
+
+private:
+    State                     m_State;
+    uint8_t                   m_Header[3];
+    uint8_t                   m_Trailer[2];
+    size_t                    m_Have;
+    size_t                    m_Length;
+    size_t                    m_Limit;
+    size_t                    m_Skipped;
+    std::vector<uint8_t>      m_Payload;
+};
+
+// *****************************************************************************
+// Function     [ wireDumpText ]
+// Description  [ Format bytes read back as the ASCII firmware sends them:
+//                lines of 'aaaa: ' and 16 'xx', 54 characters each, so the
+//                dump handlers take either.
+//              ]
+// *****************************************************************************
+void                          wireDumpText(const uint8_t *data, size_t n, std::string &out);
+
+// *****************************************************************************
+// Function     [ wireDumpParse ]
+// Description  [ The other way, for the ASCII firmware's dump. Each line
+//                must be whole, at the address that follows on from the
+//                one before, with nothing but hex pairs in it, so a
+//                dropped or garbled character is an error rather than a
+//                byte that reads wrong. A dump that stops at the end of a
+//                line is fine as far as it goes. Returns false on the first bad line, with its
+//                number, from 0, in badLine.
+//              ]
+// *****************************************************************************
+bool                          wireDumpParse(const char *text, size_t n, std::vector<uint8_t> &out,
+                                            size_t *badLine = nullptr);
+
+#endif /* WIREPROTOCOL_H */
@@ -0,0 +1,161 @@
+// *****************************************************************************
+// File         [ wireReply.cpp ]
+// Description  [ Implementation of the wireReply class ]
+// Author       [ Keith Sabine ]
+// *****************************************************************************
+
+#include "wireReply.h"
+
+#include <algorithm>
+
+// *****************************************************************************
+// Function     [ token ]
+// Description  [ ]
+// *****************************************************************************
+wireReply
+wireReply::token(std::initializer_list<const char *> tokens)
+{
+    wireReply r;
+    r.m_Kind = Token;
+    for (const char *t : tokens) {
+        r.m_Tokens.push_back(t);
+    }
+    return r;
+}
+
+// *****************************************************************************
+// Function     [ digits ]
+// Description  [ ]
+// *****************************************************************************
+wireReply
+wireReply::digits(size_t count)
+{
+    wireReply r;
+    r.m_Kind = Digits;
+    r.m_Count = count;
+    return r;
+}
+
+// *****************************************************************************
+// Function     [ dump ]
+// Description  [ Each line ends in a newline, the last one included ]
+// *****************************************************************************
+wireReply
+wireReply::dump(size_t bytes)
+{
+    wireReply r;
+    r.m_Kind = Dump;
+    r.m_Count = (bytes + 15) / 16;
+    return r;
+}
+
+// *****************************************************************************
+// Function     [ frame ]
+// Description  [ ]
+// *****************************************************************************
+wireReply
+wireReply::frame(wireFrame::Type type, size_t limit)
+{
+    wireReply r;
+    r.m_Kind = Frame;
+    r.m_Type = type;
+    r.m_Decoder.setLimit(limit);
+    return r;
+}
+
+// *****************************************************************************
+// Function     [ reset ]
+// Description  [ ]
+// *****************************************************************************
+void
+wireReply::reset()
+{
+    m_Seen = 0;
+    m_Complete = false;
+    m_Head.clear();
+    m_Decoder.reset();
+}
+
+// *****************************************************************************
+// Function     [ feed ]
+// Description  [ A token must be the whole reply, so one that has grown
+//                longer than them all never completes, and nor does a
+//                number with something other than a digit in it. They are
+//                left to the line going quiet.
+//              ]
+// *****************************************************************************
+bool
+wireReply::feed(const char *data, size_t n)
+{
+    if (m_Complete) {
+        return true;
+    }
+    switch (m_Kind) {
+    case Open:
+        break;
+
+    case Token: {
+        size_t longest = 0;
+        for (const std::string &t : m_Tokens) {
+            longest = std::max(longest, t.size());
+        }
+        if (m_Head.size() <= longest) {
+            m_Head.append(data, std::min(n, longest + 1 - m_Head.size()));
+            m_Complete = std::find(m_Tokens.begin(), m_Tokens.end(), m_Head) != m_Tokens.end();
+        }
+        break;
+    }
+
+    case Digits:
+        for (size_t i = 0; i < n && m_Seen != (size_t) -1; ++i) {
+            m_Seen = (data[i] >= '0' && data[i] <= '9') ? m_Seen + 1 : (size_t) -1;
+        }
+        m_Complete = m_Seen == m_Count;
+        break;
+
+    case Dump:
+        m_Seen += (size_t) std::count(data, data + n, '\n');
+        m_Complete = m_Seen >= m_Count;
+        break;
+
+    case Frame: {
+        const uint8_t *p = reinterpret_cast<const uint8_t *>(data);
+        m_Decoder.feed(p, n);
+        m_Complete = m_Decoder.done();
+        break;
+    }
+    }
+    return m_Complete;
+}
+
+// *****************************************************************************
+// Function     [ ok ]
+// Description  [ ]
+// *****************************************************************************
+bool
+wireReply::ok() const
+{
+    if (m_Kind == Frame) {
+        return m_Decoder.ok() && m_Decoder.type() == m_Type;
+    }
+    return m_Complete;
+}
+
+// *****************************************************************************
+// Function     [ text ]
+// Description  [ Empty for a frame that isn't ok(), or a reply that is
+//                neither
+//              ]
+// *****************************************************************************
+std::string
+wireReply::text() const
+{
+    if (m_Kind == Token) {
+        return m_Complete ? m_Head : std::string();
+    }
+    if (m_Kind == Frame && ok()) {
+        const std::vector<uint8_t> &payload = m_Decoder.payload();
+        return std::string(payload.begin(), payload.end());
+    }
+    return std::string();
+}
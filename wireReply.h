@@ -0,0 +1,106 @@
+#ifndef WIREREPLY_H
+#define WIREREPLY_H
+
+// *****************************************************************************
+// File         [ wireReply.h ]
+// Description  [ Knowing when a reply from the programmer is all in. The
+//                host used to take a reply as finished once the line had
+//                been quiet for 10 or 100mS, so every exchange paid that on
+//                top. Each reply has a shape that says where it ends: OK,
+//                the baud rate divisor's digits, a dump of the device, one
+//                frame. Anything that doesn't fit its shape still ends
+//                when the line goes quiet, as before. Once the programmer
+//                frames its replies, every one is a frame, complete at its
+//                CRC and known good or bad right then.
+//              ]
+// Author       [ Keith Sabine ]
+// *****************************************************************************
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <vector>
+#include "wireProtocol.h"
+
+// *****************************************************************************
+// Class        [ wireReply ]
+// Description  [ Fed the reply as it arrives, says when it is complete.
+//                feed() takes it all and only looks; the caller keeps the
+//                bytes. A frame's payload, and a token, are kept as well,
+//                for the reply's text.
+//              ]
+// *****************************************************************************
+class wireReply
+{
+public:
+    enum Kind
+    {
+        Open,                    // no known end, only the line going quiet
+        Token,                   // one of a few fixed replies, e.g. OK or CRC
+        Digits,                  // a number, so many digits long
+        Dump,                    // an ASCII dump of so many bytes, 16 a line
+        Frame                    // one binary frame, of a given type
+    };
+
+    wireReply() : m_Kind(Open), m_Type(wireFrame::Status), m_Count(0) { reset(); }
+
+    static wireReply          open() { return wireReply(); }
+    static wireReply          token(std::initializer_list<const char *> tokens);
+    static wireReply          digits(size_t count);
+    static wireReply          dump(size_t bytes);
+    static wireReply          frame(wireFrame::Type type, size_t limit = wireMaxPayload);
+    // A Status frame, the framed OK or CRC
+    static wireReply          status() { return frame(wireFrame::Status, wireStatusMax); }
+
+    void                      reset();
+    // Returns true once the reply is complete
+    bool                      feed(const char *data, size_t n);
+
+    Kind                      kind() const { return m_Kind; }
+    bool                      complete() const { return m_Complete; }
+    // Complete and as expected: a frame of the right type with a good CRC
+    bool                      ok() const;
+    const std::vector<uint8_t> &payload() const { return m_Decoder.payload(); }
+    // The token, or a good frame's payload, as text
+    std::string               text() const;
+
+private:
+    Kind                      m_Kind;
+    wireFrame::Type           m_Type;
+    std::vector<std::string>  m_Tokens;
+    size_t                    m_Count;      // digits, or dump lines
+    size_t                    m_Seen;
+    bool                      m_Complete;
+    std::string               m_Head;       // the start, for the tokens
+    wireDecoder               m_Decoder;
+};
+
+// *****************************************************************************
+// Function     [ wireReadReply ]
+// Description  [ For the serialHub job that waits on the port itself, the
+//                burn engine's. port need only have the waitForReadyRead()
+//                and readAll() of a QSerialPort. Waits up to first mS for
+//                the reply to start, then up to gap mS for each more part
+//                of it, but no longer once it is complete. Returns false if
+//                nothing came.
+//              ]
+// *****************************************************************************
+template <class Port, class Bytes>
+bool
+wireReadReply(Port &port, wireReply &reply, int32_t first, int32_t gap, Bytes &out)
+{
+    reply.reset();
+    if (!port.waitForReadyRead(first)) {
+        return false;
+    }
+    for (;;) {
+        const Bytes in = port.readAll();
+        out += in;
+        if (reply.feed(in.data(), (size_t) in.size()) || !port.waitForReadyRead(gap)) {
+            return true;
+        }
+    }
+}
+
+#endif /* WIREREPLY_H */
@@ -0,0 +1,60 @@
+// *****************************************************************************
+// File         [ wireStream.cpp ]
+// Description  [ Implementation of the wireStream class ]
+// Author       [ Keith Sabine ]
+// *****************************************************************************
+
+#include "wireStream.h"
+#include "hexCodec.h"
+#include "wireProtocol.h"
+
+#include <cstdio>
+#include <cstring>
+
+// *****************************************************************************
+// Function     [ build ]
+// Description  [ The size goes as the threads always sent it, in lower case
+//                hex of at least two digits. In ASCII each span is encoded
+//                in one go by the bulk hex routines.
+//              ]
+// *****************************************************************************
+void
+wireStream::build(const char *command, const hexSpanView &spans, bool binary)
+{
+    size_t count = 0;
+    for (auto iter = spans.begin(); iter != spans.end(); ++iter) {
+        count += iter->size;
+    }
+
+    char size[16];
+    const size_t commandSize = std::strlen(command);
+    const size_t fieldSize = binary ? wireHeaderSize
+                                    : (size_t) std::snprintf(size, sizeof(size), "%02x", (uint32_t) (uint16_t) count);
+    m_Width = binary ? 1 : 2;
+    m_Count = count;
+    m_Head = commandSize + fieldSize;
+    m_Buffer.resize(m_Head + m_Count * m_Width + (binary ? wireTrailerSize : 0));
+
+    char *out = m_Buffer.data();
+    std::memcpy(out, command, commandSize);
+    out += commandSize;
+
+    if (binary) {
+        wireEncoder wire(true);
+        out += wire.begin(wireFrame::Data, (uint16_t) count, out);
+        for (auto iter = spans.begin(); iter != spans.end(); ++iter) {
+            for (size_t i = 0; i < iter->size; ++i) {
+                out += wire.byte(iter->data[i], out);
+            }
+        }
+        wire.end(out);
+        return;
+    }
+
+    std::memcpy(out, size, fieldSize);
+    out += fieldSize;
+    for (auto iter = spans.begin(); iter != spans.end(); ++iter) {
+        hexEncode(iter->data, iter->size, out);
+        out += 2 * iter->size;
+    }
+}
@@ -0,0 +1,56 @@
+#ifndef WIRESTREAM_H
+#define WIRESTREAM_H
+
+// *****************************************************************************
+// File         [ wireStream.h ]
+// Description  [ Everything a write sends, built once before the burn into
+//                one buffer: the cmd, the size, each data byte raw or as a
+//                hex pair, and in binary the CRC. The paced loop then only
+//                hands slices of it to the serial port, with no strings
+//                made and nothing allocated per byte. A 2708, written 100
+//                times over, builds it once for all the passes.
+//              ]
+// Author       [ Keith Sabine ]
+// *****************************************************************************
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "hexImage.h"
+
+// *****************************************************************************
+// Class        [ wireStream ]
+// Description  [ The head is the cmd and the size, two (or more) hex chars
+//                in ASCII or the frame header in binary. The tail is the
+//                frame's CRC, empty in ASCII. Building again reuses the
+//                buffer.
+//              ]
+// *****************************************************************************
+class wireStream
+{
+public:
+    wireStream() : m_Head(0), m_Width(1), m_Count(0) {}
+
+    void                      build(const char *command, const hexSpanView &spans, bool binary);
+
+    const char              * head() const { return m_Buffer.data(); }
+    size_t                    headSize() const { return m_Head; }
+
+    // The data bytes, each width() chars on the wire
+    size_t                    count() const { return m_Count; }
+    size_t                    width() const { return m_Width; }
+    const char              * byte(size_t i) const { return m_Buffer.data() + m_Head + i * m_Width; }
+
+    const char              * tail() const { return byte(m_Count); }
+    size_t                    tailSize() const { return m_Buffer.size() - m_Head - m_Count * m_Width; }
+
+    size_t                    size() const { return m_Buffer.size(); }
+
+private:
+    std::vector<char>         m_Buffer;
+    size_t                    m_Head;
+    size_t                    m_Width;
+    size_t                    m_Count;
+};
+
+#endif /* WIRESTREAM_H */